@@ -161,6 +161,8 @@ inline void configuration::standard( PartitionConfig & partition_config ) {
 
         partition_config.time_limit 				            = 0;
         partition_config.mh_pool_size                           = 5;
+        partition_config.mh_diversity_sketch_size               = 0;
+        partition_config.mh_diversity_verify                    = false;
         partition_config.local_partitioning_repetitions 	    = 1;
 
         partition_config.mh_disable_cross_combine               = false;
@@ -316,6 +318,29 @@ inline void configuration::standard( PartitionConfig & partition_config ) {
         // signed graph clustering parameters
         partition_config.gen_random_signed_graph = false;
         partition_config.n_threads = 1;
+        partition_config.parallel_label_propagation = false;
+        partition_config.parallel_lp_refinement = false;
+        partition_config.deterministic_tie_breaking = false;
+        partition_config.deterministic = false;
+        partition_config.deterministic_sub_rounds = 4;
+        partition_config.parallel_kway_fm = false;
+        partition_config.kway_fm_seeds_per_search = 25;
+        partition_config.kway_fm_step_limit = 15;
+        partition_config.kway_gain_cache = false;
+        partition_config.sign_split_adjacency = false;
+        partition_config.statistics_output = "";
+        partition_config.statistics = NULL;
+        partition_config.use_huge_pages = false;
+        partition_config.use_compressed_graph = false;
+        partition_config.clustering_engine = CLUSTERING_ENGINE_MULTILEVEL;
+        partition_config.pivot_lp_refinement = false;
+        partition_config.pivot_initial_clustering = false;
+        partition_config.kernelization = false;
+        partition_config.cluster_merge_refinement = false;
+        partition_config.cluster_merge_rounds = 5;
+        partition_config.positive_component_decomposition = false;
+        partition_config.positive_component_task_size = 10000;
+        partition_config.workspace = NULL;
         //partition_config.overall_best_cut = NULL;
         //partition_config.local_best_cut = std::numeric_limits<int>::max();
         //overall_best_cut
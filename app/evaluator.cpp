@@ -11,6 +11,7 @@
 
 #include "data_structure/graph_access.h"
 #include "graph_io.h"
+#include "mmap_graph_io.h"
 #include "macros_assertions.h"
 #include "parse_parameters.h"
 #include "partition/partition_config.h"
@@ -36,7 +37,13 @@ int main(int argn, char **argv) {
         }
 
         graph_access G;     
-        graph_io::readGraphWeighted(G, graph_filename);
+        if(kahip::mmap_io::is_binary_graph_file(graph_filename)) {
+                kahip::mmap_io::graph_from_binary_file(G, graph_filename);
+        } else if(partition_config.use_mmap_io) {
+                kahip::mmap_io::graph_from_metis_file(G, graph_filename, partition_config.n_threads);
+        } else {
+                graph_io::readGraphWeighted(G, graph_filename);
+        }
 
         if (partition_config.gen_random_signed_graph) {
             std::stringstream filename;
@@ -13,8 +13,10 @@
 #include <limits>
 #include <vector>
 #include <unordered_set>
+#include <omp.h>
 #include "quality_metrics.h"
 #include "graph_io.h"
+#include "mmap_graph_io.h"
 
 using namespace std;
 
@@ -23,13 +25,30 @@ using namespace std;
 int main(int argn, char **argv)
 {
 
-        if( argn != 2 ) {
-                std::cout <<  "Usage: graphchecker FILE"  << std::endl;
+        if( argn != 2 && !(argn == 4 && std::string(argv[2]) == "--to-binary")
+                      && !(argn == 4 && std::string(argv[2]) == "--edge-list-to-binary") ) {
+                std::cout <<  "Usage: graphchecker FILE [--to-binary OUTPUT]"  << std::endl;
+                std::cout <<  "       graphchecker EDGELIST --edge-list-to-binary OUTPUT"  << std::endl;
                 exit(0);
         }
 
+        if( argn == 4 && std::string(argv[2]) == "--edge-list-to-binary" ) {
+                // signed edge list "x y weight" with a header line "n m", nodes are relabeled
+                graph_access G;
+                std::vector<NodeID> map_real_virtual;
+                if( graph_io::readWeightedEdgeStreamToGraph(G, argv[1], map_real_virtual, true, omp_get_max_threads()) ) {
+                        return 1;
+                }
+                kahip::mmap_io::graph_to_binary_file(G, argv[3]);
+                graph_io::writeMap(map_real_virtual, std::string(argv[3]) + ".map");
+                std::cout <<  "graph has " <<  G.number_of_nodes() <<  " nodes and " <<  G.number_of_edges() <<  " edges"  << std::endl;
+                std::cout <<  "Binary graph written to " << argv[3] << ", node ids of the edge list to " << argv[3] << ".map" << std::endl;
+                return 0;
+        }
+
         std::string line;
         std::string filename(argv[1]);
+        std::string binary_filename(argn == 4 ? argv[3] : "");
 
         // open file for reading
         std::ifstream in(filename.c_str());
@@ -270,6 +289,11 @@ int main(int argn, char **argv)
         quality_metrics qm;
         std::cout << "Total value of the wieghts for negative edges \t" << qm.neg_edges(G) << std::endl;
 
+        if( binary_filename != "" ) {
+                kahip::mmap_io::graph_to_binary_file(G, binary_filename);
+                std::cout <<  "Binary graph written to " << binary_filename << std::endl;
+        }
+
         return 0;
 }
 
@@ -28,7 +28,7 @@ int parse_parameters(int argn, char **argv,
 
         // Setup argtable parameters.
         struct arg_lit *help                                 = arg_lit0(NULL, "help","Print help.");
-        struct arg_lit *use_mmap_io                          = arg_lit0(NULL, "mmap_io", "Use mmap graph IO (experimental).");
+        struct arg_lit *use_mmap_io                          = arg_lit0(NULL, "mmap_io", "Read the graph with the parallel mmap based METIS parser (uses --n_threads threads where available). (Default: disabled)");
         struct arg_lit *edge_rating_tiebreaking              = arg_lit0(NULL, "edge_rating_tiebreaking","Enable random edgerating tiebreaking.");
         struct arg_lit *only_first_level                     = arg_lit0(NULL, "only_first_level","Disable Multilevel Approach. Only perform on the first level. (Currently only initial partitioning).");
         struct arg_lit *graph_weighted                       = arg_lit0(NULL, "weighted","Read the graph as weighted graph.");
@@ -155,6 +155,29 @@ int parse_parameters(int argn, char **argv,
         // Signed Graph Clustering
         struct arg_lit *gen_random_signed_graph              = arg_lit0(NULL, "gen_random_signed_graph", "Generate signed graph by randomly multiplying the weight of some edges by -1.");
         struct arg_int *n_threads			     = arg_int0(NULL, "n_threads", NULL, "Number of threads to be used. (Default: 1)");
+        struct arg_lit *parallel_label_propagation	     = arg_lit0(NULL, "parallel_label_propagation", "Use shared-memory parallel label propagation during coarsening (uses --n_threads threads). (Default: disabled)");
+        struct arg_lit *parallel_lp_refinement		     = arg_lit0(NULL, "parallel_lp_refinement", "Use shared-memory parallel label propagation refinement during uncoarsening (uses --n_threads threads). (Default: disabled)");
+        struct arg_lit *parallel_kway_fm		     = arg_lit0(NULL, "parallel_kway_fm", "Use parallel localized k-way FM local search (uses --n_threads threads). (Default: disabled)");
+        struct arg_int *kway_fm_seeds_per_search	     = arg_int0(NULL, "kway_fm_seeds_per_search", NULL, "Number of boundary nodes that seed one search of the parallel k-way FM. Larger batches mean fewer searches, i.e. less running time but also less local search. (Default: 25)");
+        struct arg_int *kway_fm_step_limit		     = arg_int0(NULL, "kway_fm_step_limit", NULL, "Number of moves without improvement after which a (sequential or localized parallel) k-way FM search stops. (Default: 15)");
+        struct arg_lit *sign_split_adjacency		     = arg_lit0(NULL, "sign_split_adjacency", "Store the positive edges of every node before the negative ones so that label propagation only scans the negative edges once. (Default: disabled)");
+        struct arg_lit *huge_pages		     = arg_lit0(NULL, "huge_pages", "Back the scratch buffers of a clustering run by transparent huge pages (madvise). (Default: disabled)");
+        struct arg_lit *compressed_graph	     = arg_lit0(NULL, "compressed_graph", "Keep the input graph gap/varint compressed and cluster its finest level on the compressed adjacency. (Default: disabled)");
+        struct arg_rex *clustering_engine		     = arg_rex0(NULL, "clustering_engine", "^(multilevel|pivot)$", "ENGINE", REG_EXTENDED, "Clustering algorithm. pivot runs parallel KwikCluster style pivot rounds on the positive edges, much faster but with a worse cut. (Default: multilevel) [multilevel|pivot]");
+        struct arg_lit *pivot_lp_refinement		     = arg_lit0(NULL, "pivot_lp_refinement", "Run one pass of label propagation refinement after the pivot engine. (Default: disabled)");
+        struct arg_lit *pivot_initial_clustering	     = arg_lit0(NULL, "pivot_initial_clustering", "Cluster the coarsest graph by pivot rounds instead of singletons. (Default: disabled)");
+        struct arg_lit *cluster_merge			     = arg_lit0(NULL, "cluster_merge", "Merge pairs of clusters with positive aggregate weight on the quotient graph between label propagation refinement and k-way FM. (Default: disabled)");
+        struct arg_int *cluster_merge_rounds		     = arg_int0(NULL, "cluster_merge_rounds", NULL, "Maximum number of merge rounds of --cluster_merge per level. (Default: 5)");
+        struct arg_lit *kernelization			     = arg_lit0(NULL, "kernelization", "Apply exact reduction rules (nodes without positive edges, dominating positive edges) before clustering and cluster the reduced graph. (Default: disabled)");
+        struct arg_lit *positive_components		     = arg_lit0(NULL, "positive_components", "Split the graph into the connected components of its positive edges and cluster them independently (uses --n_threads threads). (Default: disabled)");
+        struct arg_int *positive_component_task_size	     = arg_int0(NULL, "positive_component_task_size", NULL, "Minimum number of nodes of a task of --positive_components. Smaller components are bundled. (Default: 10000)");
+        struct arg_str *statistics_output		     = arg_str0(NULL, "statistics_output", NULL, "Write per level counters and timings of every clustering run to this file (CSV if it ends with .csv, JSON otherwise). (Default: disabled)");
+        struct arg_lit *kway_gain_cache		     = arg_lit0(NULL, "kway_gain_cache", "Keep the connectivity of every node to its adjacent clusters in a gain cache during k-way FM instead of recomputing gains. Needs about 24*(m+n) bytes. (Default: disabled)");
+        struct arg_lit *deterministic_tie_breaking	     = arg_lit0(NULL, "deterministic_tie_breaking", "Break ties in parallel label propagation refinement by a hash of seed, node and cluster instead of random numbers. (Default: disabled)");
+        struct arg_lit *deterministic			     = arg_lit0(NULL, "deterministic", "Make the parallel label propagation, label propagation refinement and k-way FM independent of the number of threads. (Default: disabled)");
+        struct arg_int *deterministic_sub_rounds	     = arg_int0(NULL, "deterministic_sub_rounds", NULL, "Number of synchronous sub-rounds per label propagation iteration in --deterministic mode. (Default: 4)");
+        struct arg_int *mh_diversity_sketch_size	     = arg_int0(NULL, "mh_diversity_sketch_size", NULL, "Estimate the difference of the cut edges of an offspring and the individuals of the population from MinHash sketches of this size when inserting it. 0 compares the cut edges exactly. (Default: 0)");
+        struct arg_lit *mh_diversity_verify		     = arg_lit0(NULL, "mh_diversity_verify", "With --mh_diversity_sketch_size, compare the cut edges exactly for the individuals whose estimate is within two standard errors of the most similar one. (Default: disabled)");
         struct arg_lit *elitism				     = arg_lit0(NULL, "elitism", "Enable elitism in each core. (Default: disabled)");
         struct arg_lit *disable_label_propagation	     = arg_lit0(NULL, "disable_label_propagation", "Disable label propagation local search. (Default: enabled)");
         struct arg_lit *disable_quotient_refinement	     = arg_lit0(NULL, "disable_quotient_refinement", "Disable quotioent graph FM local search local search. (Default: enabled)");
@@ -192,6 +215,8 @@ int parse_parameters(int argn, char **argv,
                 preconfiguration, 
                 input_partition,
 		gen_random_signed_graph,
+                use_mmap_io,
+		n_threads,
 #elif defined MODE_GRAPH_TRANSLATOR
                 filename_output, 
 		no_relabel,
@@ -234,12 +259,37 @@ int parse_parameters(int argn, char **argv,
 		ensemble_clusterings,
 		label_propagation_iterations,
 		fm_search_limit,
+		n_threads,
+		parallel_label_propagation,
+		parallel_lp_refinement,
+		deterministic_tie_breaking,
+		deterministic,
+		deterministic_sub_rounds,
+		parallel_kway_fm,
+		kway_fm_seeds_per_search,
+		kway_fm_step_limit,
+		kway_gain_cache,
+		sign_split_adjacency,
+		huge_pages,
+		compressed_graph,
+		clustering_engine,
+		pivot_lp_refinement,
+		pivot_initial_clustering,
+		kernelization,
+		cluster_merge,
+		cluster_merge_rounds,
+		positive_components,
+		positive_component_task_size,
+		statistics_output,
+                use_mmap_io,
 		        /* mh_print_log, */
 			filename_log,
 #elif defined MODE_CLUSTERING_EVOLUTIONARY
                 time_limit,  
 		user_seed,
 		elitism,
+		mh_diversity_sketch_size,
+		mh_diversity_verify,
                 input_partition,
 		input_partition2,
                 filename_output,
@@ -254,6 +304,28 @@ int parse_parameters(int argn, char **argv,
 		ensemble_clusterings,
 		label_propagation_iterations,
 		fm_search_limit,
+		n_threads,
+		parallel_label_propagation,
+		parallel_lp_refinement,
+		deterministic_tie_breaking,
+		deterministic,
+		deterministic_sub_rounds,
+		parallel_kway_fm,
+		kway_fm_seeds_per_search,
+		kway_fm_step_limit,
+		kway_gain_cache,
+		sign_split_adjacency,
+		huge_pages,
+		clustering_engine,
+		pivot_lp_refinement,
+		pivot_initial_clustering,
+		kernelization,
+		cluster_merge,
+		cluster_merge_rounds,
+		positive_components,
+		positive_component_task_size,
+		statistics_output,
+                use_mmap_io,
 		        /* mh_print_log, */
 			filename_log,
 #endif
@@ -566,6 +638,14 @@ int parse_parameters(int argn, char **argv,
                 partition_config.mh_pool_size = mh_pool_size->ival[0];
         }
 
+        if(mh_diversity_sketch_size->count > 0) {
+                partition_config.mh_diversity_sketch_size = std::max(0, mh_diversity_sketch_size->ival[0]);
+        }
+
+        if(mh_diversity_verify->count > 0) {
+                partition_config.mh_diversity_verify = true;
+        }
+
         if(mh_penalty_for_unconnected->count > 0) {
                 partition_config.mh_penalty_for_unconnected = true;
         }
@@ -953,6 +1033,97 @@ int parse_parameters(int argn, char **argv,
             partition_config.n_threads = n_threads->ival[0];
         }
 
+        if(parallel_label_propagation->count > 0) {
+            partition_config.parallel_label_propagation = true;
+        }
+
+        if(parallel_lp_refinement->count > 0) {
+            partition_config.parallel_lp_refinement = true;
+        }
+
+        if(deterministic_tie_breaking->count > 0) {
+            partition_config.deterministic_tie_breaking = true;
+        }
+
+        if(deterministic->count > 0) {
+            partition_config.deterministic = true;
+        }
+
+        if(deterministic_sub_rounds->count > 0) {
+            partition_config.deterministic_sub_rounds = deterministic_sub_rounds->ival[0];
+        }
+
+        if(parallel_kway_fm->count > 0) {
+            partition_config.parallel_kway_fm = true;
+        }
+
+        if(kway_fm_seeds_per_search->count > 0) {
+            partition_config.kway_fm_seeds_per_search = kway_fm_seeds_per_search->ival[0];
+        }
+
+        if(kway_fm_step_limit->count > 0) {
+            partition_config.kway_fm_step_limit = kway_fm_step_limit->ival[0];
+        }
+
+        if(kway_gain_cache->count > 0) {
+            partition_config.kway_gain_cache = true;
+        }
+
+        if(sign_split_adjacency->count > 0) {
+            partition_config.sign_split_adjacency = true;
+        }
+
+        if(huge_pages->count > 0) {
+            partition_config.use_huge_pages = true;
+        }
+
+        if(compressed_graph->count > 0) {
+            partition_config.use_compressed_graph = true;
+        }
+
+        if(clustering_engine->count > 0) {
+            if(strcmp("multilevel", clustering_engine->sval[0]) == 0) {
+                partition_config.clustering_engine = CLUSTERING_ENGINE_MULTILEVEL;
+            } else if(strcmp("pivot", clustering_engine->sval[0]) == 0) {
+                partition_config.clustering_engine = CLUSTERING_ENGINE_PIVOT;
+            } else {
+                fprintf(stderr, "Invalid clustering engine: \"%s\"\n", clustering_engine->sval[0]);
+                exit(0);
+            }
+        }
+
+        if(pivot_lp_refinement->count > 0) {
+            partition_config.pivot_lp_refinement = true;
+        }
+
+        if(pivot_initial_clustering->count > 0) {
+            partition_config.pivot_initial_clustering = true;
+        }
+
+        if(kernelization->count > 0) {
+            partition_config.kernelization = true;
+        }
+
+        if(cluster_merge->count > 0) {
+            partition_config.cluster_merge_refinement = true;
+        }
+
+        if(cluster_merge_rounds->count > 0) {
+            partition_config.cluster_merge_rounds = cluster_merge_rounds->ival[0];
+        }
+
+        if(positive_components->count > 0) {
+            partition_config.positive_component_decomposition = true;
+        }
+
+        if(positive_component_task_size->count > 0) {
+            partition_config.positive_component_task_size = positive_component_task_size->ival[0];
+        }
+
+        if(statistics_output->count > 0) {
+            partition_config.statistics_output = statistics_output->sval[0];
+        }
+
         if (elitism->count > 0) {
                 partition_config.elitism = true;
         }
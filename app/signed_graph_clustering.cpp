@@ -4,21 +4,46 @@
 
 #include <argtable3.h>
 #include <lib/clustering/signed_graph_clusterer.h>
+#include <lib/clustering/uncoarsening/refinement/kway_graph_refinement/kway_gain_cache.h>
 #include <tools/tools.h>
 #include <mpi.h>
+#include <sys/resource.h>
 #include "parse_parameters.h"
 #include "partition/partition_config.h"
+#include "data_structure/compressed_graph.h"
 #include "data_structure/graph_access.h"
 #include "timer.h"
+#include "compressed_graph_io.h"
 #include "graph_io.h"
+#include "mmap_graph_io.h"
+#include "shared_graph_io.h"
 #include "random_functions.h"
 #include "quality_metrics.h"
+#include "tools/clustering_statistics.h"
+#include "tools/mpi_tools.h"
 
 #define MIN(A,B) (((A)>(B))?(B):(A))
 #define MAX(A,B) (((A)>(B))?(A):(B))
 
 void write_log(std::string & filename, std::stringstream& filebuffer_string);
 
+EdgeWeight edge_cut(PartitionConfig & partition_config, graph_access & G) {
+        quality_metrics qm;
+        return qm.edge_cut(G);
+}
+
+EdgeWeight edge_cut(PartitionConfig & partition_config, compressed_graph & G) {
+        return G.edge_cut(partition_config.n_threads);
+}
+
+// reads the input partition into G and numbers its clusters consecutively
+template <typename Graph>
+void read_input_partition(PartitionConfig & partition_config, Graph & G);
+
+// one clustering run or repeated runs until the time limit, returns the best cut (the clustering is stored in G)
+template <typename Graph>
+EdgeWeight perform_clustering(PartitionConfig & partition_config, Graph & G, timer & t, int rank, std::stringstream & filebuffer_string);
+
 int main(int argn, char **argv) {
         MPI_Init(&argn, &argv);    /* starts MPI */
         std::stringstream filebuffer_string;
@@ -64,37 +89,44 @@ int main(int argn, char **argv) {
         MPI_Comm_rank( communicator, &rank);
         MPI_Comm_size( communicator, &size);
 
+        clustering_statistics statistics;
+        if(partition_config.statistics_output != "") {
+                partition_config.statistics = &statistics;
+        }
+
         //std::cout <<  "AB"  << std::endl;
         partition_config.LogDump(stdout);
         graph_access G;
+        compressed_graph CG; // the graph with --compressed_graph, G stays empty then
 
         timer t;
-        graph_io::readGraphWeighted(G, graph_filename);
+        if(partition_config.use_compressed_graph) {
+                kahip::mmap_io::read_compressed_graph(CG, graph_filename, partition_config);
+        } else {
+                kahip::shared_io::read_graph_node_shared(G, graph_filename, partition_config, communicator);
+        }
 
         if(partition_config.input_partition != "") {
                 std::cout <<  "reading input partition" << std::endl;
-                graph_io::readPartition(G, partition_config.input_partition);
-                partition_config.graph_already_partitioned = true;
-
-                int k = 0;
-                std::vector<bool> used_block(G.number_of_nodes(),false);
-                std::vector<PartitionID> map_old_new(G.number_of_nodes(),0);
-                forall_nodes(G, n) {
-                        PartitionID old_block = G.getPartitionIndex(n);
-                        if (!used_block[old_block]) {
-                                used_block[old_block] = true;
-                                map_old_new[old_block] = k++;
-                        }
-                        PartitionID new_block = map_old_new[old_block];
-                        G.setPartitionIndex(n, new_block);
-                } endfor
-                partition_config.k = k;
-                G.set_partition_count(partition_config.k);
+                if(partition_config.use_compressed_graph) {
+                        read_input_partition(partition_config, CG);
+                } else {
+                        read_input_partition(partition_config, G);
+                }
         }
 
         if( rank == ROOT ) {
                 std::cout << "io time: " << t.elapsed()  << std::endl;
-                std::cout <<  "graph has " <<  G.number_of_nodes() <<  " nodes and " <<  G.number_of_edges() <<  " edges"  << std::endl;
+                if(partition_config.use_compressed_graph) {
+                        std::cout <<  "graph has " <<  CG.number_of_nodes() <<  " nodes and " <<  CG.number_of_edges() <<  " edges"  << std::endl;
+                        std::cout << "compressed graph memory: " << CG.memory_in_bytes()/(1024.0*1024.0) << " MB" << std::endl;
+                } else {
+                        std::cout <<  "graph has " <<  G.number_of_nodes() <<  " nodes and " <<  G.number_of_edges() <<  " edges"  << std::endl;
+                        std::cout << "graph memory: " << G.memory_in_bytes()/(1024.0*1024.0) << " MB" << std::endl;
+                        if(partition_config.kway_gain_cache) {
+                                std::cout << "gain cache memory: " << kway_gain_cache::memory_in_bytes(G)/(1024.0*1024.0) << " MB" << std::endl;
+                        }
+                }
                 //MPI_Win_allocate_shared(bytes, sizeof(EdgeWeight) [> disp_unit <], info_win, comm_shared, &base_ptr, &win_shared);
                 //partition_config.overall_best_cut = base_ptr;
                 //*(partition_config.overall_best_cut) = std::numeric_limits<EdgeWeight>::max();
@@ -110,61 +142,36 @@ int main(int argn, char **argv) {
 
         // ***************************** perform clustering ***************************************
         t.restart();
-        quality_metrics qm;
-
         std::cout <<  "performing clustering!"  << std::endl;
-        EdgeWeight local_best_cut = std::numeric_limits<int>::max();
-        if(partition_config.time_limit == 0) {
-                signed_graph_clusterer clusterer;
-                clusterer.perform_signed_clustering(partition_config, G);
-                best_cut = qm.edge_cut(G);
-                if (best_cut < local_best_cut) local_best_cut = best_cut;
+        EdgeWeight local_best_cut = std::numeric_limits<EdgeWeight>::max();
+        if(partition_config.use_compressed_graph) {
+                local_best_cut = perform_clustering(partition_config, CG, t, rank, filebuffer_string);
         } else {
-                PartitionID* map = new PartitionID[G.number_of_nodes()];
-                forall_nodes(G, node) {
-                        map[node] = 0;
-                } endfor
-                PartitionID best_k = G.number_of_nodes();
-                while(t.elapsed() < partition_config.time_limit) {
-                        signed_graph_clusterer clusterer;
-                        partition_config.graph_already_partitioned = false;
-                        clusterer.perform_signed_clustering(partition_config, G);
-                        EdgeWeight cut = qm.edge_cut(G);
-                        if(cut < (local_best_cut)) {
-                                std::cout << "Improved objective: " << cut << " Elapsed time: " << t.elapsed() << " Rank: " << rank << std::endl;
-                                best_cut = cut;
-                                local_best_cut = best_cut;
-                                forall_nodes(G, node) {
-                                        map[node] = G.getPartitionIndex(node);
-                                } endfor
-                                best_k = G.get_partition_count();
-                        }
-                        filebuffer_string <<  t.elapsed() <<  " " <<  cut <<  std::endl;
-                }
-
-                forall_nodes(G, node) {
-                        G.setPartitionIndex(node, map[node]);
-                } endfor
-                delete[] map;
-                partition_config.k = best_k;
-                G.set_partition_count(partition_config.k);
+                local_best_cut = perform_clustering(partition_config, G, t, rank, filebuffer_string);
         }
+        best_cut = local_best_cut;
         MPI_Barrier(communicator);
 
-        int overall_best_cut;
-        MPI_Reduce(&local_best_cut, &overall_best_cut, 1, MPI_INT, MPI_MIN, 0, MPI_COMM_WORLD);
+        EdgeWeight overall_best_cut;
+        MPI_Allreduce(&local_best_cut, &overall_best_cut, 1, MPI_EDGEWEIGHT, MPI_MIN, MPI_COMM_WORLD);
 
-        int myrank = local_best_cut == overall_best_cut ? rank : 0;
+        int myrank = local_best_cut == overall_best_cut ? rank : std::numeric_limits<int>::max();
         int minrank;
 
-        MPI_Reduce(&myrank, &minrank, 1, MPI_INT, MPI_MIN, 0, MPI_COMM_WORLD);
+        MPI_Allreduce(&myrank, &minrank, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
 
         if( overall_best_cut == best_cut && rank == minrank ) {
                 std::cout <<  "time spent for partitioning " << t.elapsed()  << std::endl;
 
+                // peak resident memory of this rank (ru_maxrss is in KB), to compare the graph representations
+                struct rusage usage;
+                getrusage(RUSAGE_SELF, &usage);
+                std::cout << "peak memory: " << usage.ru_maxrss/1024.0 << " MB" << std::endl;
+
                 // ******************************* done clustering *****************************************
                 // output some information about the clustering that we have computed
-                EdgeWeight cut =  qm.edge_cut(G);
+                EdgeWeight cut = partition_config.use_compressed_graph ? edge_cut(partition_config, CG)
+                                                                       : edge_cut(partition_config, G);
                 std::cout << "cut \t\t"         << cut				  << std::endl;
                 //std::cout << "z_value\t\t"      << qm.z_value(G)		  << std::endl;
                 //std::cout << "error_rate \t"    << qm.error_rate(G)               << std::endl;
@@ -183,7 +190,11 @@ int main(int argn, char **argv) {
                         } else {
                                 filename << partition_config.filename_output;
                         }
-                        graph_io::writePartition(G, filename.str());
+                        if(partition_config.use_compressed_graph) {
+                                graph_io::writePartition(CG, filename.str());
+                        } else {
+                                graph_io::writePartition(G, filename.str());
+                        }
                 }
         }
 
@@ -199,6 +210,13 @@ int main(int argn, char **argv) {
         //MPI_Info_free(&info_win);
         //MPI_Win_free(&win_shared);
         //MPI_Comm_free(&comm_shared);
+        if(partition_config.statistics) {
+                statistics.write(size > 1 ? clustering_statistics::filename_of_rank(partition_config.statistics_output, rank)
+                                           : partition_config.statistics_output);
+        }
+
+        // the arrays of G may live in a window that is shared with the other ranks of this node
+        G.release_memory();
         MPI_Finalize();
 }
 
@@ -208,3 +226,62 @@ void write_log(std::string & filename, std::stringstream& filebuffer_string) {
         f.close();
 }
 
+template <typename Graph>
+void read_input_partition(PartitionConfig & partition_config, Graph & G) {
+        graph_io::readPartition(G, partition_config.input_partition);
+        partition_config.graph_already_partitioned = true;
+
+        int k = 0;
+        std::vector<bool> used_block(G.number_of_nodes(),false);
+        std::vector<PartitionID> map_old_new(G.number_of_nodes(),0);
+        forall_nodes(G, n) {
+                PartitionID old_block = G.getPartitionIndex(n);
+                if (!used_block[old_block]) {
+                        used_block[old_block] = true;
+                        map_old_new[old_block] = k++;
+                }
+                PartitionID new_block = map_old_new[old_block];
+                G.setPartitionIndex(n, new_block);
+        } endfor
+        partition_config.k = k;
+        G.set_partition_count(partition_config.k);
+}
+
+template <typename Graph>
+EdgeWeight perform_clustering(PartitionConfig & partition_config, Graph & G, timer & t, int rank, std::stringstream & filebuffer_string) {
+        EdgeWeight local_best_cut = std::numeric_limits<EdgeWeight>::max();
+        if(partition_config.time_limit == 0) {
+                signed_graph_clusterer clusterer;
+                clusterer.perform_signed_clustering(partition_config, G);
+                local_best_cut = edge_cut(partition_config, G);
+        } else {
+                PartitionID* map = new PartitionID[G.number_of_nodes()];
+                forall_nodes(G, node) {
+                        map[node] = 0;
+                } endfor
+                PartitionID best_k = G.number_of_nodes();
+                while(t.elapsed() < partition_config.time_limit) {
+                        signed_graph_clusterer clusterer;
+                        partition_config.graph_already_partitioned = false;
+                        clusterer.perform_signed_clustering(partition_config, G);
+                        EdgeWeight cut = edge_cut(partition_config, G);
+                        if(cut < (local_best_cut)) {
+                                std::cout << "Improved objective: " << cut << " Elapsed time: " << t.elapsed() << " Rank: " << rank << std::endl;
+                                local_best_cut = cut;
+                                forall_nodes(G, node) {
+                                        map[node] = G.getPartitionIndex(node);
+                                } endfor
+                                best_k = G.get_partition_count();
+                        }
+                        filebuffer_string <<  t.elapsed() <<  " " <<  cut <<  std::endl;
+                }
+
+                forall_nodes(G, node) {
+                        G.setPartitionIndex(node, map[node]);
+                } endfor
+                delete[] map;
+                partition_config.k = best_k;
+                G.set_partition_count(partition_config.k);
+        }
+        return local_best_cut;
+}
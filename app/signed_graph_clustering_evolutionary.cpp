@@ -3,20 +3,27 @@
 //
 
 #include <argtable3.h>
+#include <omp.h>
 #include <clustering_evolutionary/evolutionary_signed_graph_clusterer.h>
+#include <clustering/uncoarsening/refinement/kway_graph_refinement/kway_gain_cache.h>
 #include <tools/tools.h>
 #include "parse_parameters.h"
 #include "partition/partition_config.h"
 #include "data_structure/graph_access.h"
 #include "timer.h"
 #include "graph_io.h"
+#include "mmap_graph_io.h"
+#include "shared_graph_io.h"
 #include "macros_assertions.h"
 #include "random_functions.h"
 #include "quality_metrics.h"
+#include "tools/clustering_statistics.h"
 #include "algorithms/cycle_search.h"
 
 int main(int argn, char **argv) {
-	MPI_Init(&argn, &argv);    /* starts MPI */
+	// the worker threads of a rank do not communicate, only the master thread calls MPI
+	int thread_support;
+	MPI_Init_thread(&argn, &argv, MPI_THREAD_FUNNELED, &thread_support);    /* starts MPI */
 
 	// Reading the graph
 	PartitionConfig partition_config;
@@ -60,11 +67,28 @@ int main(int argn, char **argv) {
 	MPI_Comm_rank( communicator, &rank);
 	MPI_Comm_size( communicator, &size);
 
+	// the worker threads need MPI_THREAD_FUNNELED, otherwise every rank runs single threaded
+	if( thread_support < MPI_THREAD_FUNNELED ) {
+		if( rank == ROOT && partition_config.n_threads > 1 ) {
+			std::cout <<  "MPI does not support threads, using one thread per rank" << std::endl;
+		}
+		partition_config.n_threads = 1;
+		omp_set_num_threads(1);
+	}
+
+	clustering_statistics statistics;
+	if(partition_config.statistics_output != "") {
+		partition_config.statistics = &statistics;
+	}
+
 	timer t;
-	graph_io::readGraphWeighted(G, graph_filename);
+	kahip::shared_io::read_graph_node_shared(G, graph_filename, partition_config, communicator);
 	if( rank == ROOT ) {
 		std::cout << "io time: " << t.elapsed()  << std::endl;
 		std::cout <<  "graph has " <<  G.number_of_nodes() <<  " nodes and " <<  G.number_of_edges() <<  " edges"  << std::endl;
+		if(partition_config.kway_gain_cache) {
+			std::cout << "gain cache memory: " << kway_gain_cache::memory_in_bytes(G)/(1024.0*1024.0) << " MB" << std::endl;
+		}
 		//MPI_Win_allocate_shared(bytes, sizeof(EdgeWeight) [> disp_unit <], info_win, comm_shared, &base_ptr, &win_shared);
 		//partition_config.overall_best_cut = base_ptr;
 		//*(partition_config.overall_best_cut) = std::numeric_limits<EdgeWeight>::max();
@@ -78,8 +102,6 @@ int main(int argn, char **argv) {
         srand(partition_config.seed+(rank*rank));
         random_functions::setSeed(partition_config.seed+(rank*rank));
 
-	omp_set_num_threads(1);
-
 	// ***************************** perform clustering ***************************************
 	/* std::cout <<  "graph has " <<  G.number_of_nodes() <<  " nodes and " <<  G.number_of_edges() <<  " edges"  << std::endl; */
 	/* std::cout <<  "performing clustering!"  << std::endl; */
@@ -190,5 +212,12 @@ int main(int argn, char **argv) {
 	//MPI_Info_free(&info_win);
 	//MPI_Win_free(&win_shared);
 	//MPI_Comm_free(&comm_shared);
+	if(partition_config.statistics) {
+		statistics.write(size > 1 ? clustering_statistics::filename_of_rank(partition_config.statistics_output, rank)
+		                           : partition_config.statistics_output);
+	}
+
+	// the arrays of G may live in a window that is shared with the other ranks of this node
+	G.release_memory();
 	MPI_Finalize();
 }
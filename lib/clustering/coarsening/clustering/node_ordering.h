@@ -21,7 +21,9 @@ public:
         node_ordering();
         virtual ~node_ordering();
 
-        void order_nodes(const PartitionConfig & config, graph_access & G, std::vector< NodeID > & ordered_nodes) {
+        // Graph is graph_access or compressed_graph
+        template <typename Graph>
+        void order_nodes(const PartitionConfig & config, Graph & G, std::vector< NodeID > & ordered_nodes) {
                 forall_nodes(G, node) {
                         ordered_nodes[node] = node;
                 } endfor
@@ -39,18 +41,21 @@ public:
                  }
         }
 
-        void order_nodes_random(const PartitionConfig & config, graph_access & G, std::vector< NodeID > & ordered_nodes) { 
+        template <typename Graph>
+        void order_nodes_random(const PartitionConfig & config, Graph & G, std::vector< NodeID > & ordered_nodes) { 
                 random_functions::permutate_vector_fast(ordered_nodes, false);
         }
 
-        void order_nodes_degree(const PartitionConfig & config, graph_access & G, std::vector< NodeID > & ordered_nodes) { 
+        template <typename Graph>
+        void order_nodes_degree(const PartitionConfig & config, Graph & G, std::vector< NodeID > & ordered_nodes) { 
                 std::sort( ordered_nodes.begin(), ordered_nodes.end(), 
                            [&]( const NodeID & lhs, const NodeID & rhs) -> bool {
                                 return (G.getNodeDegree(lhs) < G.getNodeDegree(rhs));
                            });
         }
 
-        void order_nodes_weighted_degree(const PartitionConfig & config, graph_access & G, std::vector< NodeID > & ordered_nodes) { 
+        template <typename Graph>
+        void order_nodes_weighted_degree(const PartitionConfig & config, Graph & G, std::vector< NodeID > & ordered_nodes) { 
                 std::sort( ordered_nodes.begin(), ordered_nodes.end(), 
                            [&]( const NodeID & lhs, const NodeID & rhs) -> bool {
                                 return (G.getWeightedNodeDegree(lhs) < G.getWeightedNodeDegree(rhs));
@@ -5,14 +5,22 @@
  * Christian Schulz <christian.schulz.phone@gmail.com>
  *****************************************************************************/
 
+#include <omp.h>
 #include <unordered_map>
+#include "data_structure/clustering_workspace.h"
+#include "data_structure/compressed_graph.h"
+#include "data_structure/rating_map.h"
 #include "data_structure/union_find.h"
 #include "node_ordering.h"
 #include "clustering/uncoarsening/refinement/kway_graph_refinement/kway_graph_refinement_commons.h"
+#include "tools/clustering_statistics.h"
 #include "tools/quality_metrics.h"
 #include "tools/random_functions.h"
 #include "size_constraint_label_propagation.h"
 
+// number of nodes a thread grabs at once in the parallel label propagation
+const NodeID PARALLEL_LP_CHUNK_SIZE = 1024;
+
 size_constraint_label_propagation::size_constraint_label_propagation() {
                 
 }
@@ -21,8 +29,9 @@ size_constraint_label_propagation::~size_constraint_label_propagation() {
                 
 }
 
+template <typename Graph>
 void size_constraint_label_propagation::match(const PartitionConfig & partition_config, 
-                                              graph_access & G,
+                                              Graph & G,
                                               CoarseMapping & coarse_mapping, 
                                               NodeID & no_of_coarse_vertices,
                                               NodeID & labels_changed) {
@@ -36,17 +45,20 @@ void size_constraint_label_propagation::match(const PartitionConfig & partition_
         }
 }
 
+template <typename Graph>
 void size_constraint_label_propagation::match_internal(const PartitionConfig & partition_config,
-                                                      graph_access & G,
+                                                      Graph & G,
                                                       CoarseMapping & coarse_mapping,
                                                       NodeID & no_of_coarse_vertices,
                                                       NodeID & labels_changed) {
-        std::vector<NodeID> cluster_id(G.number_of_nodes());
+        clustering_workspace local_workspace;
+        std::vector<NodeID> & cluster_id = partition_config.workspace ? partition_config.workspace->cluster_id : local_workspace.cluster_id;
         label_propagation(partition_config, G, cluster_id, no_of_coarse_vertices, labels_changed);
         create_coarsemapping(G, cluster_id, coarse_mapping);
 }
 
-void size_constraint_label_propagation::ensemble_two_clusterings( graph_access & G, 
+template <typename Graph>
+void size_constraint_label_propagation::ensemble_two_clusterings( Graph & G, 
                                                                   std::vector<NodeID> & lhs, 
                                                                   std::vector<NodeID> & rhs, 
                                                                   std::vector< NodeID > & output,
@@ -72,8 +84,9 @@ void size_constraint_label_propagation::ensemble_two_clusterings( graph_access &
 }
 
 
+template <typename Graph>
 void size_constraint_label_propagation::ensemble_clusterings(const PartitionConfig & partition_config, 
-                                                             graph_access & G,
+                                                             Graph & G,
                                                              CoarseMapping & coarse_mapping, 
                                                              NodeID & no_of_coarse_vertices,
                                                              NodeID & labels_changed) {
@@ -105,23 +118,68 @@ void size_constraint_label_propagation::ensemble_clusterings(const PartitionConf
 
 }
 
+template <typename Graph>
 void size_constraint_label_propagation::label_propagation(const PartitionConfig & partition_config, 
-                                                         graph_access & G, 
+                                                         Graph & G, 
                                                          std::vector<NodeID> & cluster_id,
                                                          NodeID & no_of_blocks,
                                                          NodeID & labels_changed) {
+        // the modes are fixed during a level, the kernels are selected once instead of testing them per edge
+        bool partitioned = partition_config.graph_already_partitioned;
+        bool combine     = partition_config.combine;
+        if( partition_config.parallel_label_propagation ) {
+                if( partitioned && combine ) {
+                        parallel_label_propagation<true, true>(partition_config, G, cluster_id, no_of_blocks, labels_changed);
+                } else if( partitioned ) {
+                        parallel_label_propagation<true, false>(partition_config, G, cluster_id, no_of_blocks, labels_changed);
+                } else if( combine ) {
+                        parallel_label_propagation<false, true>(partition_config, G, cluster_id, no_of_blocks, labels_changed);
+                } else {
+                        parallel_label_propagation<false, false>(partition_config, G, cluster_id, no_of_blocks, labels_changed);
+                }
+        } else {
+                if( partitioned && combine ) {
+                        sequential_label_propagation<true, true>(partition_config, G, cluster_id, no_of_blocks, labels_changed);
+                } else if( partitioned ) {
+                        sequential_label_propagation<true, false>(partition_config, G, cluster_id, no_of_blocks, labels_changed);
+                } else if( combine ) {
+                        sequential_label_propagation<false, true>(partition_config, G, cluster_id, no_of_blocks, labels_changed);
+                } else {
+                        sequential_label_propagation<false, false>(partition_config, G, cluster_id, no_of_blocks, labels_changed);
+                }
+        }
+}
+
+template <bool respect_partition, bool respect_second_partition, typename Graph>
+void size_constraint_label_propagation::sequential_label_propagation(const PartitionConfig & partition_config, 
+                                                                    Graph & G, 
+                                                                    std::vector<NodeID> & cluster_id,
+                                                                    NodeID & no_of_blocks,
+                                                                    NodeID & labels_changed) {
 	random_functions::fastRandBool<uint64_t> random_obj;
         // coarse_mapping stores cluster id and the mapping (it is identical)
         /* std::vector<bool> blocked(G.number_of_nodes(), false); */
         /* std::vector<NodeWeight> cluster_sizes(G.number_of_nodes(), 0); */
-        std::vector<EdgeWeight> hash_map(G.number_of_nodes(), 0);
-        std::vector<NodeID> permutation(G.number_of_nodes());
+        clustering_workspace local_workspace;
+        clustering_workspace & workspace = partition_config.workspace ? *partition_config.workspace : local_workspace;
+
+        std::vector<EdgeWeight> & hash_map = workspace.hash_map;
+        std::vector<bool> & rated          = workspace.rated;
+        std::vector<NodeID> & permutation  = workspace.permutation;
+        hash_map.assign(G.number_of_nodes(), 0);
+        rated.assign(G.number_of_nodes(), false);
+        permutation.resize(G.number_of_nodes());
         cluster_id.resize(G.number_of_nodes());
 
-        std::queue< NodeID > * Q             = new std::queue< NodeID >();
-        std::queue< NodeID > * next_Q        = new std::queue< NodeID >();
-        std::vector<bool> * Q_contained      = new std::vector<bool>(G.number_of_nodes(), false);
-        std::vector<bool> * next_Q_contained = new std::vector<bool> (G.number_of_nodes(), false);
+        // the queues are processed front to back and then swapped, i.e. plain arrays suffice
+        std::vector< NodeID > * Q            = &workspace.queue;
+        std::vector< NodeID > * next_Q       = &workspace.next_queue;
+        std::vector<bool> * Q_contained      = &workspace.queue_contained;
+        std::vector<bool> * next_Q_contained = &workspace.next_queue_contained;
+        Q->clear();
+        next_Q->clear();
+        Q_contained->assign(G.number_of_nodes(), false);
+        next_Q_contained->assign(G.number_of_nodes(), false);
 
         node_ordering n_ordering;
         n_ordering.order_nodes(partition_config, G, permutation);
@@ -129,20 +187,30 @@ void size_constraint_label_propagation::label_propagation(const PartitionConfig
         forall_nodes(G, node) {
                 /* cluster_sizes[node] += G.getNodeWeight(node); */
                 cluster_id[node]     = node;
-                Q->push(permutation[node]);
+                Q->push_back(permutation[node]);
         } endfor
 
+        unsigned iterations = 0;
         for( int j = 0; j < partition_config.label_iterations; j++) {
-                while( !Q->empty() ) {
-                        NodeID node = Q->front();
-                        Q->pop();
+                if( Q->empty() ) break;
+                iterations++;
+
+                for( size_t q = 0; q < Q->size(); q++) {
+                        NodeID node = (*Q)[q];
                         (*Q_contained)[node] = false;
 
                         //now move the node to the cluster that is most common in the neighborhood
-                        forall_out_edges(G, e, node) {
-                                NodeID target = G.getEdgeTarget(e);
-                                hash_map[cluster_id[target]]+=G.getEdgeWeight(e);
-				/* if (G.getEdgeWeight(e) < 0) blocked[cluster_id[target]] = true; */
+                        //only clusters that are reached by a positive edge are candidates, without
+                        //a sign split layout all edges are in the positive range
+                        forall_positive_neighbors(G, it, node) {
+                                NodeID target = it.target();
+                                hash_map[cluster_id[target]]+=it.weight();
+                                rated[cluster_id[target]] = true;
+				/* if (it.weight() < 0) blocked[cluster_id[target]] = true; */
+                        } endfor
+                        forall_negative_neighbors(G, it, node) {
+                                NodeID target = it.target();
+                                if( rated[cluster_id[target]] ) hash_map[cluster_id[target]]+=it.weight();
                         } endfor
 
                         //second sweep for finding max and resetting array
@@ -150,24 +218,25 @@ void size_constraint_label_propagation::label_propagation(const PartitionConfig
 
                         /* EdgeWeight max_value = hash_map[max_block]; */
                         EdgeWeight max_value = 0;
-                        forall_out_edges(G, e, node) {
-                                NodeID target             = G.getEdgeTarget(e);
+                        forall_positive_neighbors(G, it, node) {
+                                NodeID target             = it.target();
                                 PartitionID cur_block     = cluster_id[target];
                                 EdgeWeight cur_value      = hash_map[cur_block];
 				/* if (blocked[cur_block]) continue; */
                                 if((cur_value > max_value || (cur_value == max_value && random_obj.nextBool()))
-                                && (!partition_config.graph_already_partitioned  || G.getPartitionIndex(node) == G.getPartitionIndex(target) )
-                                && (!partition_config.combine || G.getSecondPartitionIndex(node) == G.getSecondPartitionIndex(target) ))
+                                && (!respect_partition  || G.getPartitionIndex(node) == G.getPartitionIndex(target) )
+                                && (!respect_second_partition || G.getSecondPartitionIndex(node) == G.getSecondPartitionIndex(target) ))
                                 {
                                         max_value = cur_value;
                                         max_block = cur_block;
                                 }
                         } endfor
 
-                        forall_out_edges(G, e, node) {
-                                NodeID target             = G.getEdgeTarget(e);
+                        forall_positive_neighbors(G, it, node) {
+                                NodeID target             = it.target();
                                 PartitionID cur_block     = cluster_id[target];
                                 hash_map[cur_block] = 0;
+                                rated[cur_block]    = false;
 				/* blocked[cur_block] = false; */
                         } endfor
 
@@ -177,20 +246,25 @@ void size_constraint_label_propagation::label_propagation(const PartitionConfig
                         cluster_id[node]                  = max_block;
 
                         if(changed_label) {
-                                forall_out_edges(G, e, node) {
-                                            NodeID target = G.getEdgeTarget(e);
+                                forall_neighbors(G, it, node) {
+                                            NodeID target = it.target();
                                             if(!(*next_Q_contained)[target]) {
-                                                next_Q->push(target);
+                                                next_Q->push_back(target);
                                                 (*next_Q_contained)[target] = true;
                                             }
                                 } endfor
                         }
                 }
 
+                Q->clear();
                 std::swap( Q, next_Q);
                 std::swap( Q_contained, next_Q_contained);
         }
 
+        if( partition_config.statistics ) {
+                partition_config.statistics->current().lp_iterations += iterations;
+        }
+
         labels_changed = 0;
         forall_nodes(G, node) {
             if(cluster_id[node] != node) {
@@ -201,14 +275,175 @@ void size_constraint_label_propagation::label_propagation(const PartitionConfig
         remap_cluster_ids(G, cluster_id, 
 			  no_of_blocks, 
 			  partition_config.graph_already_partitioned && partition_config.block_cut_edges_only_in_first_level);
+}
+
+template <bool respect_partition, bool respect_second_partition, typename Graph>
+void size_constraint_label_propagation::parallel_label_propagation(const PartitionConfig & partition_config, 
+                                                                  Graph & G, 
+                                                                  std::vector<NodeID> & cluster_id,
+                                                                  NodeID & no_of_blocks,
+                                                                  NodeID & labels_changed) {
+        int num_threads = std::max(1, partition_config.n_threads);
+        NodeID n        = G.number_of_nodes();
+
+        clustering_workspace local_workspace;
+        clustering_workspace & workspace = partition_config.workspace ? *partition_config.workspace : local_workspace;
+
+        std::vector<NodeID> & permutation = workspace.permutation;
+        permutation.resize(n);
+        cluster_id.resize(n);
+
+        // a node is active if one of its neighbors changed its label in the previous round
+        // (replaces the queues of the sequential version, nodes are visited in chunks of the permutation)
+        std::vector<unsigned char> & active      = workspace.active;
+        std::vector<unsigned char> & next_active = workspace.next_active;
+        std::vector<rating_map> & ratings        = workspace.ratings;
+        active.assign(n, 1);
+        next_active.assign(n, 0);
+        if( ratings.size() < (size_t)num_threads ) ratings.resize(num_threads);
+
+        node_ordering n_ordering;
+        n_ordering.order_nodes(partition_config, G, permutation);
+
+        // tie breaking uses thread local generators that are seeded by the global one. in deterministic
+        // mode ties are broken by counter based random numbers and a single seed is drawn, so the global
+        // generator advances independently of the number of threads
+        bool deterministic = partition_config.deterministic;
+        std::vector<unsigned> seeds(deterministic ? 1 : num_threads);
+        for( size_t i = 0; i < seeds.size(); i++) {
+                seeds[i] = random_functions::nextInt(0, std::numeric_limits<int>::max());
+        }
+
+        // deterministic mode: the permutation is split into sub-rounds, the nodes of a sub-round
+        // choose their labels on the labels of the previous sub-rounds and are updated afterwards
+        int sub_rounds = deterministic ? std::max(1, partition_config.deterministic_sub_rounds) : 1;
+        std::vector<NodeID> next_labels(deterministic ? n : 0);
+
+        NodeID* labels = &cluster_id[0];
+        unsigned char* next_active_ptr = NULL;
+
+        #pragma omp parallel for num_threads(num_threads) schedule(static)
+        for( NodeID node = 0; node < n; node++) {
+                labels[node] = node;
+                if( deterministic ) next_labels[node] = node;
+        }
+
+        unsigned iterations = 0;
+        for( int j = 0; j < partition_config.label_iterations; j++) {
+                NodeID moved_nodes  = 0;
+                next_active_ptr     = &next_active[0];
+                uint64_t round_seed = (uint64_t)seeds[0] * partition_config.label_iterations + j;
+
+                for( int sub_round = 0; sub_round < sub_rounds; sub_round++) {
+                        NodeID begin = (uint64_t)n * sub_round / sub_rounds;
+                        NodeID end   = (uint64_t)n * (sub_round + 1) / sub_rounds;
+
+                        #pragma omp parallel num_threads(num_threads) reduction(+:moved_nodes)
+                        {
+                                int thread_id        = omp_get_thread_num();
+                                rating_map & rating  = ratings[thread_id];
+                                std::mt19937 gen(seeds[thread_id % seeds.size()] + j);
+                                std::uniform_int_distribution<int> coin(0,1);
+
+                                #pragma omp for schedule(dynamic, PARALLEL_LP_CHUNK_SIZE)
+                                for( NodeID i = begin; i < end; i++) {
+                                        NodeID node = permutation[i];
+                                        if( !active[node] ) continue;
+                                        active[node] = 0;
+
+                                        //now move the node to the cluster that is most common in the neighborhood
+                                        rating.prepare(G.getNodeDegree(node));
+                                        forall_positive_neighbors(G, it, node) {
+                                                NodeID target = it.target();
+                                                if( (respect_partition && G.getPartitionIndex(node) != G.getPartitionIndex(target))
+                                                 || (respect_second_partition && G.getSecondPartitionIndex(node) != G.getSecondPartitionIndex(target)) ) {
+                                                        continue;
+                                                }
+                                                rating.add(__atomic_load_n(&labels[target], __ATOMIC_RELAXED), it.weight());
+                                        } endfor
+                                        forall_negative_neighbors(G, it, node) {
+                                                NodeID target = it.target();
+                                                if( (respect_partition && G.getPartitionIndex(node) != G.getPartitionIndex(target))
+                                                 || (respect_second_partition && G.getSecondPartitionIndex(node) != G.getSecondPartitionIndex(target)) ) {
+                                                        continue;
+                                                }
+                                                rating.add_if_contained(__atomic_load_n(&labels[target], __ATOMIC_RELAXED), it.weight());
+                                        } endfor
+
+                                        NodeID max_block     = labels[node];
+                                        EdgeWeight max_value = 0;
+                                        uint64_t max_hash    = deterministic ? random_functions::counter_based(round_seed, node, max_block) : 0;
+                                        for( size_t r = 0; r < rating.size(); r++) {
+                                                EdgeWeight cur_value = rating.value_at(r);
+                                                if( cur_value < max_value ) continue;
+
+                                                bool take = cur_value > max_value;
+                                                if( !take && deterministic ) {
+                                                        take = random_functions::counter_based(round_seed, node, rating.key_at(r)) < max_hash;
+                                                } else if( !take ) {
+                                                        take = coin(gen);
+                                                }
+
+                                                if( take ) {
+                                                        max_value = cur_value;
+                                                        max_block = rating.key_at(r);
+                                                        if( deterministic ) max_hash = random_functions::counter_based(round_seed, node, max_block);
+                                                }
+                                        }
+                                        rating.clear();
+
+                                        if( deterministic ) {
+                                                next_labels[node] = max_block;
+                                        } else if( max_block != labels[node] ) {
+                                                __atomic_store_n(&labels[node], max_block, __ATOMIC_RELAXED);
+                                                moved_nodes++;
+
+                                                forall_neighbors(G, it, node) {
+                                                        __atomic_store_n(&next_active_ptr[it.target()], 1, __ATOMIC_RELAXED);
+                                                } endfor
+                                        }
+                                }
+                        }
 
-        delete Q;
-        delete next_Q;
-        delete Q_contained;
-        delete next_Q_contained;
+                        if( !deterministic ) continue;
+
+                        #pragma omp parallel for num_threads(num_threads) schedule(dynamic, PARALLEL_LP_CHUNK_SIZE) reduction(+:moved_nodes)
+                        for( NodeID i = begin; i < end; i++) {
+                                NodeID node = permutation[i];
+                                if( next_labels[node] == labels[node] ) continue;
+
+                                labels[node] = next_labels[node];
+                                moved_nodes++;
+                                forall_neighbors(G, it, node) {
+                                        __atomic_store_n(&next_active_ptr[it.target()], 1, __ATOMIC_RELAXED);
+                                } endfor
+                        }
+                }
+
+                std::swap(active, next_active);
+                iterations++;
+                if( moved_nodes == 0 ) break;
+        }
+
+        if( partition_config.statistics ) {
+                partition_config.statistics->current().lp_iterations += iterations;
+        }
+
+        labels_changed = 0;
+        #pragma omp parallel for num_threads(num_threads) reduction(+:labels_changed)
+        for( NodeID node = 0; node < n; node++) {
+                if( labels[node] != node ) {
+                        labels_changed++;
+                }
+        }
+
+        parallel_remap_cluster_ids(partition_config, G, cluster_id, 
+                                   no_of_blocks, 
+                                   partition_config.graph_already_partitioned && partition_config.block_cut_edges_only_in_first_level);
 }
 
-void size_constraint_label_propagation::create_coarsemapping(graph_access & G,
+template <typename Graph>
+void size_constraint_label_propagation::create_coarsemapping(Graph & G,
                                                              std::vector<NodeID> & cluster_id,
                                                              CoarseMapping & coarse_mapping) {
         forall_nodes(G, node) {
@@ -216,7 +451,8 @@ void size_constraint_label_propagation::create_coarsemapping(graph_access & G,
         } endfor
 }
 
-void size_constraint_label_propagation::remap_cluster_ids(graph_access & G,
+template <typename Graph>
+void size_constraint_label_propagation::remap_cluster_ids(Graph & G,
                                                           std::vector<NodeID> & cluster_id,
                                                           NodeID & no_of_coarse_vertices,
 							  bool apply_to_graph) {
@@ -244,3 +480,45 @@ void size_constraint_label_propagation::remap_cluster_ids(graph_access & G,
 	}
         no_of_coarse_vertices = cur_no_clusters;
 }
+
+template <typename Graph>
+void size_constraint_label_propagation::parallel_remap_cluster_ids(const PartitionConfig & partition_config,
+                                                                   Graph & G,
+                                                                   std::vector<NodeID> & cluster_id,
+                                                                   NodeID & no_of_coarse_vertices,
+                                                                   bool apply_to_graph) {
+        // cluster ids are node ids, hence a prefix sum over the used ids yields a dense numbering
+        int num_threads = std::max(1, partition_config.n_threads);
+        NodeID n        = G.number_of_nodes();
+        std::vector<NodeID> remap(n+1, 0);
+        NodeID* remap_ptr = &remap[0];
+
+        #pragma omp parallel for num_threads(num_threads) schedule(static)
+        for( NodeID node = 0; node < n; node++) {
+                __atomic_store_n(&remap_ptr[cluster_id[node]+1], 1, __ATOMIC_RELAXED);
+        }
+
+        for( NodeID i = 1; i <= n; i++) {
+                remap[i] += remap[i-1];
+        }
+
+        #pragma omp parallel for num_threads(num_threads) schedule(static)
+        for( NodeID node = 0; node < n; node++) {
+                cluster_id[node] = remap[cluster_id[node]];
+		if( apply_to_graph ) {
+			G.setPartitionIndex(node, cluster_id[node]);
+		}
+        }
+
+	if( apply_to_graph ) {
+		G.set_partition_count(remap[n]);
+	}
+        no_of_coarse_vertices = remap[n];
+}
+
+template void size_constraint_label_propagation::match<graph_access>(const PartitionConfig & config, graph_access & G,
+                                                                     CoarseMapping & coarse_mapping, NodeID & no_of_coarse_vertices,
+                                                                     NodeID & labels_changed);
+template void size_constraint_label_propagation::match<compressed_graph>(const PartitionConfig & config, compressed_graph & G,
+                                                                         CoarseMapping & coarse_mapping, NodeID & no_of_coarse_vertices,
+                                                                         NodeID & labels_changed);
@@ -45,50 +45,84 @@ typedef std::unordered_map<const ensemble_pair,
                                 compare_ensemble_pair> hash_ensemble;
 
 
+// The kernels are instantiated for graph_access and compressed_graph (the input graph of a run
+// with --compressed_graph).
 class size_constraint_label_propagation {
         public:
                 size_constraint_label_propagation();
                 virtual ~size_constraint_label_propagation();
 
+                template <typename Graph>
                 void match(const PartitionConfig & config, 
-                                graph_access & G,
+                                Graph & G,
                                 CoarseMapping & coarse_mapping, 
                                 NodeID & no_of_coarse_vertices,
                                 NodeID & labels_changed);
 
 
+                template <typename Graph>
                 void ensemble_clusterings(const PartitionConfig & config, 
-                                graph_access & G,
+                                Graph & G,
                                 CoarseMapping & coarse_mapping, 
                                 NodeID & no_of_coarse_vertices,
                                 NodeID & labels_changed);
 
-                void ensemble_two_clusterings( graph_access & G,
+                template <typename Graph>
+                void ensemble_two_clusterings( Graph & G,
                                 std::vector<NodeID> & lhs, 
                                 std::vector<NodeID> & rhs, 
                                 std::vector< NodeID > & output,
                                 NodeID & no_of_coarse_vertices);
 
+                template <typename Graph>
                 void match_internal(const PartitionConfig & config, 
-                                graph_access & G,
+                                Graph & G,
                                 CoarseMapping & coarse_mapping, 
                                 NodeID & no_of_coarse_vertices,
                                 NodeID & labels_changed);
 
+                template <typename Graph>
                 void label_propagation(const PartitionConfig & partition_config,
-                               graph_access & G,
+                               Graph & G,
                                std::vector<NodeID> & cluster_id, // output parameter
                                NodeID & number_of_blocks,
                                NodeID & labels_changed); // output parameter
 
-                void remap_cluster_ids(graph_access & G,
+                template <typename Graph>
+                void remap_cluster_ids(Graph & G,
                                 std::vector<NodeID> & cluster_id, 
                                 NodeID & no_of_coarse_vertices,
                                 bool apply_to_graph = false); 
 
-                void create_coarsemapping(graph_access & G,
+                template <typename Graph>
+                void parallel_remap_cluster_ids(const PartitionConfig & partition_config,
+                                Graph & G,
+                                std::vector<NodeID> & cluster_id, 
+                                NodeID & no_of_coarse_vertices,
+                                bool apply_to_graph = false); 
+
+                template <typename Graph>
+                void create_coarsemapping(Graph & G,
                                 std::vector<NodeID> & cluster_id, 
                                 CoarseMapping & coarse_mapping);
+
+        private:
+                // kernels of label_propagation, respect_partition (respect_second_partition) restricts the
+                // clusters to the blocks of the partition (second partition) of G
+                template <bool respect_partition, bool respect_second_partition, typename Graph>
+                void sequential_label_propagation(const PartitionConfig & partition_config,
+                               Graph & G,
+                               std::vector<NodeID> & cluster_id, // output parameter
+                               NodeID & number_of_blocks,
+                               NodeID & labels_changed); // output parameter
+
+                // shared-memory variant, uses config.n_threads threads
+                template <bool respect_partition, bool respect_second_partition, typename Graph>
+                void parallel_label_propagation(const PartitionConfig & partition_config,
+                               Graph & G,
+                               std::vector<NodeID> & cluster_id, // output parameter
+                               NodeID & number_of_blocks,
+                               NodeID & labels_changed); // output parameter
 };
 
 
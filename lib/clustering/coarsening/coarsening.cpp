@@ -6,13 +6,17 @@
  *****************************************************************************/
 
 #include <clustering/coarsening/clustering/size_constraint_label_propagation.h>
+#include <clustering/pivot_clustering.h>
 #include <tools/tools.h>
 #include "coarsening.h"
 #include "contraction.h"
+#include "data_structure/clustering_workspace.h"
 #include "data_structure/graph_hierarchy.h"
 #include "definitions.h"
 #include "stop_rules/stop_rules.h"
 #include "quality_metrics.h"
+#include "timer.h"
+#include "tools/clustering_statistics.h"
 
 coarsening::coarsening() {
 
@@ -22,10 +26,10 @@ coarsening::~coarsening() {
 
 }
 
-void coarsening::perform_coarsening(const PartitionConfig & partition_config, graph_access & G, graph_hierarchy & hierarchy) {
+void coarsening::perform_coarsening(const PartitionConfig & partition_config, graph_access & G, graph_hierarchy & hierarchy, unsigned first_level) {
         // Variables
         PartitionConfig copy_of_partition_config = partition_config;
-        size_constraint_label_propagation* sclp = NULL;
+        size_constraint_label_propagation sclp;
         contraction* contracter = new contraction();
         simple_clustering_stop_rule* coarsening_stop_rule = new simple_clustering_stop_rule(copy_of_partition_config, G.number_of_nodes());
 
@@ -37,14 +41,29 @@ void coarsening::perform_coarsening(const PartitionConfig & partition_config, gr
         graph_access* coarser          = NULL;
         CoarseMapping* coarse_mapping  = NULL;
         bool contraction_stop = false;
+        unsigned level = first_level;
+        timer t;
 	do {
-		coarser          = new graph_access();
+                if(partition_config.statistics) {
+                        partition_config.statistics->select_level(level, finer->number_of_nodes(), finer->number_of_edges());
+                        t.restart();
+                }
+		coarser          = partition_config.workspace ? partition_config.workspace->acquire_graph() : new graph_access();
 		coarse_mapping	 = new CoarseMapping();
-		sclp = new size_constraint_label_propagation();
-		sclp->match(copy_of_partition_config, *finer, *coarse_mapping, no_of_coarser_vertices, labels_changed);
-		delete sclp;
+		sclp.match(copy_of_partition_config, *finer, *coarse_mapping, no_of_coarser_vertices, labels_changed);
+                if(partition_config.statistics) {
+                        level_statistics & stats = partition_config.statistics->current();
+                        stats.labels_changed     = labels_changed;
+                        stats.coarse_nodes       = no_of_coarser_vertices;
+                        stats.lp_time            = t.elapsed();
+                        t.restart();
+                }
 		contracter->contract_clustering(copy_of_partition_config, *finer, *coarser, *coarse_mapping, no_of_coarser_vertices);
+                if(partition_config.statistics) {
+                        partition_config.statistics->current().contraction_time = t.elapsed();
+                }
                 hierarchy.push_back(finer, coarse_mapping);
+                level++;
                 contraction_stop = coarsening_stop_rule->stop(finer->number_of_nodes(), no_of_coarser_vertices, labels_changed);
 
                 finer = coarser;
@@ -52,25 +71,75 @@ void coarsening::perform_coarsening(const PartitionConfig & partition_config, gr
         hierarchy.push_back(finer, NULL); // append the last created level
 
 	// Initial Clustering
-	std::vector<int> partition_map(finer->number_of_nodes());
-	forall_nodes((*finer), node) {
-		partition_map[node] = node;
-	} endfor
+        initial_clustering(partition_config, *finer);
+
+        delete contracter;
+        delete coarsening_stop_rule;
+}
+
+template <typename Graph>
+bool coarsening::perform_first_level(const PartitionConfig & partition_config, Graph & G, graph_access & coarser, CoarseMapping & coarse_mapping) {
+        PartitionConfig copy_of_partition_config = partition_config;
+        size_constraint_label_propagation sclp;
+        contraction contracter;
+        simple_clustering_stop_rule coarsening_stop_rule(copy_of_partition_config, G.number_of_nodes());
+
+        NodeID no_of_coarser_vertices;
+        NodeID labels_changed;
+        timer t;
+
+        if(partition_config.statistics) {
+                partition_config.statistics->select_level(0, G.number_of_nodes(), G.number_of_edges());
+        }
+        sclp.match(copy_of_partition_config, G, coarse_mapping, no_of_coarser_vertices, labels_changed);
+        if(partition_config.statistics) {
+                level_statistics & stats = partition_config.statistics->current();
+                stats.labels_changed     = labels_changed;
+                stats.coarse_nodes       = no_of_coarser_vertices;
+                stats.lp_time            = t.elapsed();
+                t.restart();
+        }
+        contracter.contract_clustering(copy_of_partition_config, G, coarser, coarse_mapping, no_of_coarser_vertices);
+        if(partition_config.statistics) {
+                partition_config.statistics->current().contraction_time = t.elapsed();
+        }
+
+        return coarsening_stop_rule.stop(G.number_of_nodes(), no_of_coarser_vertices, labels_changed);
+}
+
+void coarsening::initial_clustering(const PartitionConfig & partition_config, graph_access & coarsest) {
+	std::vector<int> partition_map(coarsest.number_of_nodes());
+	PartitionID no_of_clusters = coarsest.number_of_nodes();
+	if(partition_config.pivot_initial_clustering) {
+		pivot_clustering pivot;
+		std::vector<NodeID> cluster;
+		unsigned rounds;
+		no_of_clusters = pivot.compute_clusters(partition_config, coarsest, cluster, rounds);
+		forall_nodes(coarsest, node) {
+			partition_map[node] = cluster[node];
+		} endfor
+	} else {
+		forall_nodes(coarsest, node) {
+			partition_map[node] = node;
+		} endfor
+	}
 	EdgeWeight edgecut1 = 0;
 	EdgeWeight edgecut2 = 0;
         if(partition_config.graph_already_partitioned && !partition_config.force_new_initial_partitioning) {
 		quality_metrics qm;
-		edgecut1 = qm.edge_cut(*finer);
-		edgecut2 = qm.edge_cut(*finer, &(partition_map[0]));
+		edgecut1 = qm.edge_cut(coarsest);
+		edgecut2 = qm.edge_cut(coarsest, &(partition_map[0]));
 	} 
 	if(edgecut2 < edgecut1 || !partition_config.graph_already_partitioned 
 				|| partition_config.force_new_initial_partitioning) {
-		forall_nodes((*finer), node) {
-			finer->setPartitionIndex(node, partition_map[node]);
+		forall_nodes(coarsest, node) {
+			coarsest.setPartitionIndex(node, partition_map[node]);
 		} endfor
-		finer->set_partition_count(finer->number_of_nodes());
+		coarsest.set_partition_count(no_of_clusters);
 	}
-
-        delete contracter;
-        delete coarsening_stop_rule;
 }
+
+template bool coarsening::perform_first_level<graph_access>(const PartitionConfig & partition_config, graph_access & G,
+                                                            graph_access & coarser, CoarseMapping & coarse_mapping);
+template bool coarsening::perform_first_level<compressed_graph>(const PartitionConfig & partition_config, compressed_graph & G,
+                                                                graph_access & coarser, CoarseMapping & coarse_mapping);
@@ -8,6 +8,7 @@
 #ifndef COARSENING_UU97ZBTR
 #define COARSENING_UU97ZBTR
 
+#include "data_structure/compressed_graph.h"
 #include "data_structure/graph_access.h"
 #include "data_structure/graph_hierarchy.h"
 #include "partition_config.h"
@@ -17,7 +18,16 @@ public:
         coarsening ();
         virtual ~coarsening ();
 
-        void perform_coarsening(const PartitionConfig & config, graph_access & G, graph_hierarchy & hierarchy);
+        // first_level is the level of G in the statistics
+        void perform_coarsening(const PartitionConfig & config, graph_access & G, graph_hierarchy & hierarchy, unsigned first_level = 0);
+
+        // clusters and contracts the input graph (graph_access or compressed_graph) into coarser, returns
+        // whether the stop rule asks for further levels (which are then built by perform_coarsening on coarser)
+        template <typename Graph>
+        bool perform_first_level(const PartitionConfig & config, Graph & G, graph_access & coarser, CoarseMapping & coarse_mapping);
+
+        // every node of the coarsest graph forms its own cluster, unless the graph already carries a better partition
+        void initial_clustering(const PartitionConfig & config, graph_access & coarsest);
 };
 
 #endif /* end of include guard: COARSENING_UU97ZBTR */
@@ -5,10 +5,17 @@
  * Christian Schulz <christian.schulz.phone@gmail.com>
  *****************************************************************************/
 
+#include <algorithm>
+#include <omp.h>
+
 #include "contraction.h"
-#include "clustering/uncoarsening/refinement/quotient_graph_refinement/complete_boundary.h"
+#include "data_structure/clustering_workspace.h"
+#include "data_structure/compressed_graph.h"
+#include "data_structure/rating_map.h"
 #include "macros_assertions.h"
 
+const NodeID CONTRACTION_CHUNK_SIZE = 256;
+
 contraction::contraction() {
 
 }
@@ -17,42 +24,151 @@ contraction::~contraction() {
 
 }
 
-// for documentation see technical reports of christian schulz
+// builds the quotient graph of the clustering in parallel. 
+// the nodes of the finer graph are bucket sorted by their cluster id (prefix sum over the cluster sizes),
+// then every thread aggregates the edges of the clusters it owns into a private buffer. 
+// aggregated edges with zero weight are dropped. nodes mapped to UNDEFINED_NODE are dropped
+// together with their edges. a prefix sum over the coarse degrees yields the 
+// first edges of the coarse nodes and the buffers are copied into the preallocated coarse graph.
+template <typename Graph>
 void contraction::contract_clustering(const PartitionConfig & partition_config, 
-                              graph_access & G, 
+                              Graph & G, 
                               graph_access & coarser, 
                               const CoarseMapping & coarse_mapping,
                               const NodeID & no_of_coarse_vertices) const {
 
+        const NodeID n = G.number_of_nodes();
+        const int num_threads = std::max(partition_config.n_threads, 1);
+
+        // bucket sort the nodes by cluster 
+        std::vector< NodeID > cluster_start(no_of_coarse_vertices+1, 0);
+        for( NodeID node = 0; node < n; node++) {
+                if( coarse_mapping[node] == UNDEFINED_NODE ) continue;
+                cluster_start[coarse_mapping[node]+1]++;
+        }
+        for( NodeID c = 0; c < no_of_coarse_vertices; c++) {
+                cluster_start[c+1] += cluster_start[c];
+        }
+
+        clustering_workspace local_workspace;
+        clustering_workspace & workspace = partition_config.workspace ? *partition_config.workspace : local_workspace;
+
+        std::vector< NodeID > insert_pos(cluster_start.begin(), cluster_start.end()-1);
+        std::vector< NodeID > & nodes_by_cluster = workspace.nodes_by_cluster;
+        nodes_by_cluster.resize(n);
+
+        #pragma omp parallel for num_threads(num_threads) schedule(static)
+        for( NodeID node = 0; node < n; node++) {
+                if( coarse_mapping[node] == UNDEFINED_NODE ) continue;
+                NodeID pos = __atomic_fetch_add(&insert_pos[coarse_mapping[node]], 1, __ATOMIC_RELAXED);
+                nodes_by_cluster[pos] = node;
+        }
+
+        // aggregate the edges of every cluster into thread local buffers
+        std::vector< std::vector< Edge > > & edge_buffer = workspace.edge_buffer;
+        if( edge_buffer.size() < (size_t)num_threads ) edge_buffer.resize(num_threads);
+        if( workspace.ratings.size() < (size_t)num_threads ) workspace.ratings.resize(num_threads);
+        std::vector< EdgeID > buffer_start(no_of_coarse_vertices);
+        std::vector< int > buffer_owner(no_of_coarse_vertices);
+        std::vector< EdgeID > coarse_first_edge(no_of_coarse_vertices+1, 0);
+        std::vector< NodeID > representative(no_of_coarse_vertices);
+        std::vector< EdgeID > positive_degree(partition_config.sign_split_adjacency ? no_of_coarse_vertices : 0);
+
+        #pragma omp parallel num_threads(num_threads) 
+        {
+                int tid = omp_get_thread_num();
+                std::vector< Edge > & buffer = edge_buffer[tid];
+                rating_map & aggregated      = workspace.ratings[tid];
+                buffer.clear();
+
+                #pragma omp for schedule(dynamic, CONTRACTION_CHUNK_SIZE)
+                for( NodeID c = 0; c < no_of_coarse_vertices; c++) {
+                        NodeID * begin = &nodes_by_cluster[0] + cluster_start[c];
+                        NodeID * end   = &nodes_by_cluster[0] + cluster_start[c+1];
+                        // the atomic insertion above does not preserve the node order within a cluster,
+                        // sorting keeps the coarse graph independent of the number of threads
+                        std::sort(begin, end);
+
+                        EdgeID degree_sum = 0;
+                        for( NodeID * it = begin; it != end; it++) {
+                                degree_sum += G.getNodeDegree(*it);
+                        }
+                        aggregated.prepare(degree_sum);
+
+                        for( NodeID * it = begin; it != end; it++) {
+                                forall_neighbors(G, edge, *it) {
+                                        NodeID target_cluster = coarse_mapping[edge.target()];
+                                        if( target_cluster != c && target_cluster != UNDEFINED_NODE ) {
+                                                aggregated.add(target_cluster, edge.weight());
+                                        }
+                                } endfor
+                        }
+
+                        buffer_owner[c] = tid;
+                        buffer_start[c] = buffer.size();
+                        for( size_t i = 0; i < aggregated.size(); i++) {
+                                if( aggregated.value_at(i) == 0 ) continue;
+
+                                Edge edge;
+                                edge.target = aggregated.key_at(i);
+                                edge.weight = aggregated.value_at(i);
+                                buffer.push_back(edge);
+                        }
+                        coarse_first_edge[c+1] = buffer.size() - buffer_start[c];
+                        aggregated.clear();
+
+                        if( partition_config.sign_split_adjacency ) {
+                                std::vector< Edge >::iterator split = std::stable_partition(buffer.begin() + buffer_start[c], buffer.end(),
+                                                                                            [](const Edge & edge) { return edge.weight > 0; });
+                                positive_degree[c] = split - (buffer.begin() + buffer_start[c]);
+                        }
+
+                        // the last node of the cluster determines the partition index of the coarse node
+                        representative[c] = begin != end ? *(end-1) : UNDEFINED_NODE;
+                }
+        }
+
+        for( NodeID c = 0; c < no_of_coarse_vertices; c++) {
+                coarse_first_edge[c+1] += coarse_first_edge[c];
+        }
+
+        coarser.start_bulk_construction(no_of_coarse_vertices, coarse_first_edge[no_of_coarse_vertices]);
         if(partition_config.combine) {
                 coarser.resizeSecondPartitionIndex(no_of_coarse_vertices);
         }
+        if(partition_config.sign_split_adjacency) {
+                coarser.start_sign_split_edges();
+        }
 
-        //save partition map -- important if the graph is already partitioned
-        std::vector< int > partition_map(G.number_of_nodes());
-        int k = G.get_partition_count();
-        forall_nodes(G, node) {
-                partition_map[node] = G.getPartitionIndex(node);
-                G.setPartitionIndex(node, coarse_mapping[node]);
-        } endfor
-
-        G.set_partition_count(no_of_coarse_vertices);
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic, CONTRACTION_CHUNK_SIZE)
+        for( NodeID c = 0; c < no_of_coarse_vertices; c++) {
+                coarser.set_first_edge(c, coarse_first_edge[c]);
+                coarser.setNodeWeight(c, 1);
 
-        complete_boundary bnd(&G);
-        /* bnd.build(); */
-        /* bnd.getUnderlyingQuotientGraph(coarser); */
-        /* bnd.fastComputeQuotientGraph(coarser, no_of_coarse_vertices); */
-        bnd.fastComputeQuotientGraphRemoveZeroEdges(coarser, no_of_coarse_vertices);
+                const std::vector< Edge > & buffer = edge_buffer[buffer_owner[c]];
+                EdgeID pos = buffer_start[c];
+                for( EdgeID e = coarse_first_edge[c]; e < coarse_first_edge[c+1]; e++, pos++) {
+                        coarser.set_edge(e, buffer[pos].target, buffer[pos].weight);
+                }
+                if(partition_config.sign_split_adjacency) {
+                        coarser.set_first_negative_edge(c, coarse_first_edge[c] + positive_degree[c]);
+                }
 
-        G.set_partition_count(k);
-        forall_nodes(G, node) {
-                G.setPartitionIndex(node, partition_map[node]);
-                coarser.setPartitionIndex(coarse_mapping[node], G.getPartitionIndex(node));
+                NodeID node = representative[c];
+                if( node == UNDEFINED_NODE ) continue;
 
+                coarser.setPartitionIndex(c, G.getPartitionIndex(node));
                 if(partition_config.combine) {
-                        coarser.setSecondPartitionIndex(coarse_mapping[node], G.getSecondPartitionIndex(node));
+                        coarser.setSecondPartitionIndex(c, G.getSecondPartitionIndex(node));
                 }
+        }
 
-        } endfor
-
+        coarser.finish_bulk_construction();
 }
+
+template void contraction::contract_clustering<graph_access>(const PartitionConfig & partition_config, graph_access & G,
+                                                             graph_access & coarser, const CoarseMapping & coarse_mapping,
+                                                             const NodeID & no_of_coarse_vertices) const;
+template void contraction::contract_clustering<compressed_graph>(const PartitionConfig & partition_config, compressed_graph & G,
+                                                                 graph_access & coarser, const CoarseMapping & coarse_mapping,
+                                                                 const NodeID & no_of_coarse_vertices) const;
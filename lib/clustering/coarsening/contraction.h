@@ -19,8 +19,10 @@ class contraction {
                 contraction();
                 virtual ~contraction();
 
+                // Graph is graph_access or compressed_graph, the coarser graph is always a graph_access
+                template <typename Graph>
                 void contract_clustering(const PartitionConfig & partition_config, 
-                              graph_access & finer, 
+                              Graph & finer, 
                               graph_access & coarser, 
                               const CoarseMapping & coarse_mapping,
                               const NodeID & no_of_coarse_vertices) const;
@@ -0,0 +1,163 @@
+/******************************************************************************
+ * kernelization.cpp
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#include <algorithm>
+#include <omp.h>
+#include <unordered_map>
+
+#include "coarsening/contraction.h"
+#include "data_structure/parallel_union_find.h"
+#include "kernelization.h"
+
+const NodeID KERNELIZATION_CHUNK_SIZE = 1024;
+
+kernelization::kernelization() : m_kernel(NULL), m_no_of_fixed_clusters(0) {
+
+}
+
+kernelization::~kernelization() {
+        delete m_kernel;
+}
+
+template <typename Graph>
+NodeID kernelization::reduction_round(const PartitionConfig & partition_config, Graph & G,
+                                      CoarseMapping & coarse_mapping) {
+        const NodeID n        = G.number_of_nodes();
+        const int num_threads = std::max(1, partition_config.n_threads);
+        parallel_union_find uf(n);
+        std::vector<unsigned char> no_positive_edge(n, 0);
+
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic, KERNELIZATION_CHUNK_SIZE)
+        for( NodeID node = 0; node < n; node++) {
+                EdgeWeight absolute_weight = 0;
+                EdgeWeight heaviest        = 0;
+                NodeID heaviest_target     = UNDEFINED_NODE;
+                forall_neighbors(G, it, node) {
+                        absolute_weight += it.weight() > 0 ? it.weight() : -it.weight();
+                        if( it.weight() > heaviest ) {
+                                heaviest        = it.weight();
+                                heaviest_target = it.target();
+                        }
+                } endfor
+
+                if( heaviest_target == UNDEFINED_NODE ) {
+                        no_positive_edge[node] = 1;
+                        continue;
+                }
+                if( 2*heaviest <= absolute_weight ) continue;
+                if( partition_config.graph_already_partitioned
+                 && G.getPartitionIndex(node) != G.getPartitionIndex(heaviest_target) ) continue;
+                if( partition_config.combine
+                 && G.getSecondPartitionIndex(node) != G.getSecondPartitionIndex(heaviest_target) ) continue;
+
+                uf.Union(node, heaviest_target);
+        }
+
+        // the representative is the smallest node of its set, so it is numbered before the other ones
+        coarse_mapping.resize(n);
+        NodeID no_of_coarse_vertices = 0;
+        for( NodeID node = 0; node < n; node++) {
+                if( no_positive_edge[node] ) {
+                        coarse_mapping[node] = UNDEFINED_NODE;
+                        continue;
+                }
+                NodeID representative = uf.Find(node);
+                coarse_mapping[node]  = representative == node ? no_of_coarse_vertices++ : coarse_mapping[representative];
+        }
+        return no_of_coarse_vertices;
+}
+
+template <typename Graph>
+bool kernelization::reduction_step(const PartitionConfig & partition_config, Graph & current, graph_access * & coarser) {
+        const NodeID n         = m_mapping.size();
+        const NodeID current_n = current.number_of_nodes();
+        CoarseMapping coarse_mapping;
+        NodeID no_of_coarse_vertices = reduction_round(partition_config, current, coarse_mapping);
+        coarser = NULL;
+        if( no_of_coarse_vertices == current_n ) return false;
+
+        std::vector<NodeID> fixed_cluster(current_n, UNDEFINED_NODE);
+        for( NodeID node = 0; node < current_n; node++) {
+                if( coarse_mapping[node] == UNDEFINED_NODE ) fixed_cluster[node] = m_no_of_fixed_clusters++;
+        }
+        for( NodeID node = 0; node < n; node++) {
+                if( m_fixed[node] ) continue;
+                NodeID current_node = m_mapping[node];
+                if( coarse_mapping[current_node] == UNDEFINED_NODE ) {
+                        m_fixed[node]   = true;
+                        m_mapping[node] = fixed_cluster[current_node];
+                } else {
+                        m_mapping[node] = coarse_mapping[current_node];
+                }
+        }
+
+        contraction contracter;
+        coarser = new graph_access();
+        contracter.contract_clustering(partition_config, current, *coarser, coarse_mapping, no_of_coarse_vertices);
+
+        return 100*(current_n - no_of_coarse_vertices) >= current_n;
+}
+
+template <typename Graph>
+graph_access * kernelization::reduce(const PartitionConfig & partition_config, Graph & G) {
+        const NodeID n = G.number_of_nodes();
+        m_mapping.resize(n);
+        for( NodeID node = 0; node < n; node++) {
+                m_mapping[node] = node;
+        }
+        m_fixed.assign(n, false);
+        m_no_of_fixed_clusters = 0;
+
+        // the first round reads G, the following ones the plain graphs they contract
+        graph_access * current = NULL;
+        bool proceed = reduction_step(partition_config, G, current);
+        while( proceed ) {
+                graph_access * coarser = NULL;
+                proceed = reduction_step(partition_config, *current, coarser);
+                if( coarser == NULL ) break;
+                delete current;
+                current = coarser;
+        }
+        if( current == NULL ) return NULL;
+
+        m_kernel = current;
+        if( partition_config.graph_already_partitioned ) {
+                // renumber_clusters and the refinement expect block ids below the number of nodes
+                std::unordered_map<PartitionID, PartitionID> kernel_blocks;
+                forall_nodes((*m_kernel), node) {
+                        PartitionID block = m_kernel->getPartitionIndex(node);
+                        if( kernel_blocks.find(block) == kernel_blocks.end() ) {
+                                PartitionID new_block = kernel_blocks.size();
+                                kernel_blocks[block]  = new_block;
+                        }
+                        m_kernel->setPartitionIndex(node, kernel_blocks[block]);
+                } endfor
+        }
+        return m_kernel;
+}
+
+template <typename Graph>
+void kernelization::lift(const PartitionConfig & partition_config, Graph & G) {
+        const NodeID n = G.number_of_nodes();
+        // the clusters of the kernel come first, the fixed clusters follow
+        PartitionID no_of_kernel_clusters = m_kernel->number_of_nodes() > 0 ? m_kernel->get_partition_count() : 0;
+
+        #pragma omp parallel for num_threads(std::max(1, partition_config.n_threads)) schedule(static)
+        for( NodeID node = 0; node < n; node++) {
+                if( m_fixed[node] ) {
+                        G.setPartitionIndex(node, no_of_kernel_clusters + m_mapping[node]);
+                } else {
+                        G.setPartitionIndex(node, m_kernel->getPartitionIndex(m_mapping[node]));
+                }
+        }
+        G.set_partition_count(no_of_kernel_clusters + m_no_of_fixed_clusters);
+}
+
+template graph_access * kernelization::reduce<graph_access>(const PartitionConfig & partition_config, graph_access & G);
+template graph_access * kernelization::reduce<compressed_graph>(const PartitionConfig & partition_config, compressed_graph & G);
+template void kernelization::lift<graph_access>(const PartitionConfig & partition_config, graph_access & G);
+template void kernelization::lift<compressed_graph>(const PartitionConfig & partition_config, compressed_graph & G);
@@ -0,0 +1,62 @@
+/******************************************************************************
+ * kernelization.h
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#ifndef KERNELIZATION_H4VQ9C2M
+#define KERNELIZATION_H4VQ9C2M
+
+#include <vector>
+
+#include "data_structure/compressed_graph.h"
+#include "data_structure/graph_access.h"
+#include "partition_config.h"
+
+// Exact data reductions for signed graph clustering. Every round applies two rules to all nodes at once:
+//  - a node without positive edges forms a cluster of its own (separating it never increases the cut)
+//  - a positive edge {u,v} whose weight exceeds the absolute weight of all other edges of u is
+//    contracted (moving u to the cluster of v strictly decreases the cut, so u and v share a cluster in
+//    every optimal clustering). This covers nodes whose only edge is positive.
+// The contracted edges are collapsed by a union-find, the nodes of the first rule are removed and the
+// reduced graph is built by contraction. Contraction creates new candidates, so the rounds are repeated
+// until a round removes less than 1% of the nodes. Every round takes linear time.
+//
+// If the graph is already partitioned (cycles, combine), only edges inside a block (of both partitions)
+// are contracted, so the kernel can represent the input partition. The input graph is graph_access or
+// compressed_graph, the kernel is always a plain graph.
+class kernelization {
+        public:
+                kernelization();
+                virtual ~kernelization();
+
+                // returns the kernel (owned by this object) or NULL if no rule applies to G
+                template <typename Graph>
+                graph_access * reduce(const PartitionConfig & partition_config, Graph & G);
+
+                // sets the clustering of G from the clustering of the kernel, cluster ids stay dense
+                template <typename Graph>
+                void lift(const PartitionConfig & partition_config, Graph & G);
+
+        private:
+                // applies the rules once to G, coarse_mapping maps to the nodes of the next graph and to
+                // UNDEFINED_NODE for the nodes that form a cluster of their own. returns the number of nodes
+                // of the next graph
+                template <typename Graph>
+                NodeID reduction_round(const PartitionConfig & partition_config, Graph & G,
+                                       CoarseMapping & coarse_mapping);
+
+                // one round on current: updates the mapping of the input nodes and contracts current into
+                // coarser (NULL if no rule applies). returns whether another round is worthwhile
+                template <typename Graph>
+                bool reduction_step(const PartitionConfig & partition_config, Graph & current, graph_access * & coarser);
+
+                graph_access *      m_kernel;
+                // node of the kernel for every node of the input graph, or its cluster if m_fixed is set
+                std::vector<NodeID> m_mapping;
+                std::vector<bool>   m_fixed;
+                PartitionID         m_no_of_fixed_clusters;
+};
+
+#endif /* end of include guard: KERNELIZATION_H4VQ9C2M */
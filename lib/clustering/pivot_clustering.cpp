@@ -0,0 +1,171 @@
+/******************************************************************************
+ * pivot_clustering.cpp
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#include <algorithm>
+#include <limits>
+#include <omp.h>
+
+#include "clustering/uncoarsening/refinement/label_propagation_refinement/label_propagation_refinement.h"
+#include "pivot_clustering.h"
+#include "random_functions.h"
+#include "timer.h"
+#include "tools/clustering_statistics.h"
+
+const NodeID PIVOT_CHUNK_SIZE = 1024;
+
+// the positive neighbors are scanned through forall_positive_neighbors, a compressed graph always
+// keeps its edges grouped by sign
+static void split_edges_by_sign(const PartitionConfig & partition_config, graph_access & G) {
+        if( partition_config.sign_split_adjacency && !G.has_sign_split_edges() ) {
+                G.split_edges_by_sign(partition_config.n_threads);
+        }
+}
+
+static void split_edges_by_sign(const PartitionConfig & partition_config, compressed_graph & G) {
+}
+
+pivot_clustering::pivot_clustering() {
+
+}
+
+pivot_clustering::~pivot_clustering() {
+
+}
+
+template <typename Graph>
+NodeID pivot_clustering::compute_clusters(const PartitionConfig & partition_config, Graph & G,
+                                          std::vector<NodeID> & cluster, unsigned & rounds) {
+        const NodeID n        = G.number_of_nodes();
+        const int num_threads = std::max(1, partition_config.n_threads);
+        const uint64_t seed   = random_functions::nextInt(0, std::numeric_limits<int>::max());
+
+        std::vector<uint64_t> priority(n);
+        #pragma omp parallel for num_threads(num_threads) schedule(static)
+        for( NodeID node = 0; node < n; node++) {
+                priority[node] = random_functions::counter_based(seed, node, 0); // only depends on the seed
+        }
+        auto precedes = [&](NodeID lhs, NodeID rhs) {
+                return priority[lhs] < priority[rhs] || (priority[lhs] == priority[rhs] && lhs < rhs);
+        };
+
+        // the pivot of every clustered node, UNDEFINED_NODE for unclustered ones
+        cluster.assign(n, UNDEFINED_NODE);
+        std::vector<unsigned char> is_pivot(n, 0);
+        std::vector<NodeID> active(n);
+        std::vector<NodeID> next_active;
+        for( NodeID node = 0; node < n; node++) {
+                active[node] = node;
+        }
+
+        rounds = 0;
+        while( !active.empty() ) {
+                rounds++;
+                const NodeID no_of_active = active.size();
+
+                #pragma omp parallel for num_threads(num_threads) schedule(dynamic, PIVOT_CHUNK_SIZE)
+                for( NodeID i = 0; i < no_of_active; i++) {
+                        NodeID node = active[i];
+                        bool pivot  = true;
+                        forall_positive_neighbors(G, it, node) {
+                                if( it.weight() <= 0 ) continue;
+                                if( cluster[it.target()] == UNDEFINED_NODE && precedes(it.target(), node) ) {
+                                        pivot = false;
+                                        break;
+                                }
+                        } endfor
+                        is_pivot[node] = pivot;
+                }
+
+                // pivots of earlier rounds have no unclustered positive neighbors left
+                #pragma omp parallel for num_threads(num_threads) schedule(dynamic, PIVOT_CHUNK_SIZE)
+                for( NodeID i = 0; i < no_of_active; i++) {
+                        NodeID node = active[i];
+                        if( is_pivot[node] ) {
+                                cluster[node] = node;
+                                continue;
+                        }
+
+                        NodeID best_pivot = UNDEFINED_NODE;
+                        forall_positive_neighbors(G, it, node) {
+                                if( it.weight() <= 0 || !is_pivot[it.target()] ) continue;
+                                if( best_pivot == UNDEFINED_NODE || precedes(it.target(), best_pivot) ) {
+                                        best_pivot = it.target();
+                                }
+                        } endfor
+                        cluster[node] = best_pivot;
+                }
+
+                next_active.clear();
+                for( NodeID i = 0; i < no_of_active; i++) {
+                        if( cluster[active[i]] == UNDEFINED_NODE ) next_active.push_back(active[i]);
+                }
+                active.swap(next_active);
+        }
+
+        // number the pivots consecutively
+        std::vector<NodeID> cluster_id(n);
+        NodeID no_of_clusters = 0;
+        for( NodeID node = 0; node < n; node++) {
+                if( cluster[node] == node ) cluster_id[node] = no_of_clusters++;
+        }
+        #pragma omp parallel for num_threads(num_threads) schedule(static)
+        for( NodeID node = 0; node < n; node++) {
+                cluster[node] = cluster_id[cluster[node]];
+        }
+        return no_of_clusters;
+}
+
+template <typename Graph>
+void pivot_clustering::perform_clustering(PartitionConfig & partition_config, Graph & G) {
+        split_edges_by_sign(partition_config, G);
+
+        if( partition_config.statistics ) {
+                partition_config.statistics->start_run();
+                partition_config.statistics->start_cycle();
+                partition_config.statistics->select_level(0, G.number_of_nodes(), G.number_of_edges());
+        }
+
+        timer t;
+        std::vector<NodeID> cluster;
+        unsigned rounds;
+        NodeID no_of_clusters = compute_clusters(partition_config, G, cluster, rounds);
+
+        #pragma omp parallel for num_threads(std::max(1, partition_config.n_threads)) schedule(static)
+        for( NodeID node = 0; node < G.number_of_nodes(); node++) {
+                G.setPartitionIndex(node, cluster[node]);
+        }
+        G.set_partition_count(no_of_clusters);
+        partition_config.k = no_of_clusters;
+
+        if( partition_config.statistics ) {
+                level_statistics & stats = partition_config.statistics->current();
+                stats.lp_iterations      = rounds;
+                stats.coarse_nodes       = no_of_clusters;
+                stats.lp_time            = t.elapsed();
+                t.restart();
+        }
+
+        if( partition_config.pivot_lp_refinement ) {
+                PartitionConfig refinement_config             = partition_config;
+                refinement_config.label_iterations_refinement = 1;
+
+                label_propagation_refinement lp_refinement;
+                lp_refinement.perform_refinement(refinement_config, G);
+                lp_refinement.remap_cluster_ids(partition_config, G);
+                if( partition_config.statistics ) {
+                        partition_config.statistics->current().lp_refinement_time = t.elapsed();
+                }
+        }
+
+        partition_config.graph_already_partitioned      = true;
+        partition_config.force_new_initial_partitioning = false;
+}
+
+template void pivot_clustering::perform_clustering<graph_access>(PartitionConfig & partition_config, graph_access & G);
+template void pivot_clustering::perform_clustering<compressed_graph>(PartitionConfig & partition_config, compressed_graph & G);
+template NodeID pivot_clustering::compute_clusters<graph_access>(const PartitionConfig & partition_config, graph_access & G,
+                                                                 std::vector<NodeID> & cluster, unsigned & rounds);
@@ -0,0 +1,40 @@
+/******************************************************************************
+ * pivot_clustering.h
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#ifndef PIVOT_CLUSTERING_8NWQ3F5K
+#define PIVOT_CLUSTERING_8NWQ3F5K
+
+#include <vector>
+
+#include "data_structure/compressed_graph.h"
+#include "data_structure/graph_access.h"
+#include "partition_config.h"
+
+// KwikCluster style clustering on the positive edges (weight > 0), parallelized in rounds. Every node
+// gets a random priority. In a round every unclustered node whose priority is smaller than the ones of
+// all its unclustered positive neighbors becomes a pivot, then every unclustered node joins the
+// adjacent pivot with the smallest priority. A round only reads the state of the previous one, so the
+// clustering depends on the seed but not on the number of threads. The node of smallest priority is
+// always a pivot, usually a few rounds suffice. Each round takes linear time. Graph is graph_access or
+// compressed_graph.
+class pivot_clustering {
+        public:
+                pivot_clustering();
+                virtual ~pivot_clustering();
+
+                // clusters G, followed by one pass of label propagation refinement if
+                // config.pivot_lp_refinement is set. the cluster ids are dense afterwards
+                template <typename Graph>
+                void perform_clustering(PartitionConfig & partition_config, Graph & G);
+
+                // dense cluster id of every node, returns the number of clusters
+                template <typename Graph>
+                NodeID compute_clusters(const PartitionConfig & partition_config, Graph & G,
+                                        std::vector<NodeID> & cluster, unsigned & rounds);
+};
+
+#endif /* end of include guard: PIVOT_CLUSTERING_8NWQ3F5K */
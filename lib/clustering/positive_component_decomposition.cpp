@@ -0,0 +1,222 @@
+/******************************************************************************
+ * positive_component_decomposition.cpp
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#include <algorithm>
+#include <limits>
+#include <omp.h>
+#include <unordered_map>
+
+#include "data_structure/parallel_union_find.h"
+#include "positive_component_decomposition.h"
+#include "random_functions.h"
+#include "signed_graph_clusterer.h"
+
+const NodeID COMPONENT_CHUNK_SIZE = 1024;
+
+positive_component_decomposition::positive_component_decomposition() {
+
+}
+
+positive_component_decomposition::~positive_component_decomposition() {
+
+}
+
+template <typename Graph>
+void positive_component_decomposition::compute_components(const PartitionConfig & partition_config, Graph & G,
+                                                          std::vector<NodeID> & component) {
+        const NodeID n        = G.number_of_nodes();
+        const int num_threads = std::max(1, partition_config.n_threads);
+        parallel_union_find uf(n);
+
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic, COMPONENT_CHUNK_SIZE)
+        for( NodeID node = 0; node < n; node++) {
+                forall_neighbors(G, it, node) {
+                        if( it.weight() > 0 && it.target() > node ) {
+                                uf.Union(node, it.target());
+                        }
+                } endfor
+        }
+
+        component.resize(n);
+        #pragma omp parallel for num_threads(num_threads) schedule(static)
+        for( NodeID node = 0; node < n; node++) {
+                component[node] = uf.Find(node);
+        }
+}
+
+template <typename Graph>
+PartitionID positive_component_decomposition::solve_task(PartitionConfig & task_config, Graph & G,
+                                                         const NodeID * begin, const NodeID * end,
+                                                         const std::vector<NodeID> & component,
+                                                         std::vector<NodeID> & local_id) {
+        NodeID n = end - begin;
+        EdgeID m = 0;
+        for( const NodeID * it = begin; it != end; it++) {
+                local_id[*it] = it - begin;
+                forall_neighbors(G, nit, *it) {
+                        if( component[nit.target()] == component[*it] ) m++;
+                } endfor
+        }
+
+        // the input partition is renumbered since the refinement uses block ids below the number of nodes
+        std::unordered_map<PartitionID, PartitionID> input_blocks;
+
+        graph_access S;
+        S.start_construction(n, m);
+        if( task_config.combine ) S.resizeSecondPartitionIndex(n);
+        for( const NodeID * it = begin; it != end; it++) {
+                NodeID node = S.new_node();
+                S.setNodeWeight(node, G.getNodeWeight(*it));
+                if( task_config.graph_already_partitioned ) {
+                        PartitionID block = G.getPartitionIndex(*it);
+                        if( input_blocks.find(block) == input_blocks.end() ) {
+                                PartitionID new_block = input_blocks.size();
+                                input_blocks[block]   = new_block;
+                        }
+                        S.setPartitionIndex(node, input_blocks[block]);
+                }
+                if( task_config.combine ) S.setSecondPartitionIndex(node, G.getSecondPartitionIndex(*it));
+
+                forall_neighbors(G, nit, *it) {
+                        NodeID target = nit.target();
+                        if( component[target] != component[*it] ) continue;
+
+                        EdgeID e_bar = S.new_edge(node, local_id[target]);
+                        S.setEdgeWeight(e_bar, nit.weight());
+                } endfor
+        }
+        S.finish_construction();
+
+        signed_graph_clusterer clusterer;
+        clusterer.perform_signed_clustering(task_config, S);
+
+        for( const NodeID * it = begin; it != end; it++) {
+                G.setPartitionIndex(*it, S.getPartitionIndex(local_id[*it]));
+        }
+        return S.get_partition_count();
+}
+
+template <typename Graph>
+void positive_component_decomposition::perform_clustering(PartitionConfig & partition_config, Graph & G) {
+        const NodeID n        = G.number_of_nodes();
+        const int num_threads = std::max(1, partition_config.n_threads);
+
+        std::vector<NodeID> component;
+        compute_components(partition_config, G, component);
+
+        // size and internal negative edges of every component, indexed by its representative
+        std::vector<NodeID> component_size(n, 0);
+        std::vector<unsigned char> has_negative_edge(n, 0);
+        NodeID* size_ptr               = &component_size[0];
+        unsigned char* has_negative_ptr = &has_negative_edge[0];
+
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic, COMPONENT_CHUNK_SIZE)
+        for( NodeID node = 0; node < n; node++) {
+                __atomic_fetch_add(&size_ptr[component[node]], 1, __ATOMIC_RELAXED);
+                forall_neighbors(G, it, node) {
+                        if( it.weight() < 0 && component[it.target()] == component[node] ) {
+                                __atomic_store_n(&has_negative_ptr[component[node]], 1, __ATOMIC_RELAXED);
+                                break;
+                        }
+                } endfor
+        }
+
+        // closed form for the trivial components, the others are assigned to tasks
+        const NodeID task_size = std::max((NodeID)1, partition_config.positive_component_task_size);
+        std::vector<NodeID> component_id(n, 0); // cluster of a trivial component, task of another one
+        std::vector<NodeID> nontrivial_components;
+        PartitionID no_of_trivial = 0;
+        for( NodeID node = 0; node < n; node++) {
+                if( component[node] != node ) continue;
+                if( has_negative_edge[node] ) {
+                        nontrivial_components.push_back(node);
+                } else {
+                        component_id[node] = no_of_trivial++;
+                }
+        }
+
+        std::stable_sort(nontrivial_components.begin(), nontrivial_components.end(), [&](const NodeID & lhs, const NodeID & rhs) {
+                return component_size[lhs] > component_size[rhs];
+        });
+
+        std::vector<NodeID> task_start(1, 0);
+        for( size_t i = 0; i < nontrivial_components.size(); i++) {
+                NodeID rep = nontrivial_components[i];
+                if( task_start.back() == 0 || component_size[rep] >= task_size
+                 || task_start.back() - task_start[task_start.size()-2] >= task_size ) {
+                        task_start.push_back(task_start.back());
+                }
+                component_id[rep]  = task_start.size() - 2;
+                task_start.back() += component_size[rep];
+        }
+        const size_t no_of_tasks = task_start.size() - 1;
+
+        // nodes of every task in increasing order
+        std::vector<NodeID> task_nodes(task_start.back());
+        std::vector<NodeID> insert_pos(task_start.begin(), task_start.end());
+        for( NodeID node = 0; node < n; node++) {
+                if( !has_negative_edge[component[node]] ) continue;
+                task_nodes[insert_pos[component_id[component[node]]]++] = node;
+        }
+
+        // every task draws from its own generator, the global one continues with a seed drawn here
+        std::vector<int> seeds(no_of_tasks);
+        for( size_t t = 0; t < no_of_tasks; t++) {
+                seeds[t] = random_functions::nextInt(0, std::numeric_limits<int>::max());
+        }
+        int continuation_seed = random_functions::nextInt(0, std::numeric_limits<int>::max());
+
+        PartitionConfig task_config = partition_config;
+        task_config.positive_component_decomposition = false;
+        task_config.workspace                        = NULL;
+
+        std::vector<NodeID> local_id(n);
+        std::vector<PartitionID> no_of_clusters(no_of_tasks, 0);
+        size_t first_concurrent_task = 0;
+        if( no_of_tasks > 0 && (no_of_tasks == 1 || 2*(task_start[1] - task_start[0]) >= task_start.back()) ) {
+                PartitionConfig config = task_config;
+                random_functions::setSeed(seeds[0]);
+                no_of_clusters[0] = solve_task(config, G, &task_nodes[0] + task_start[0], &task_nodes[0] + task_start[1],
+                                               component, local_id);
+                first_concurrent_task = 1;
+        }
+
+        task_config.n_threads  = 1;
+        task_config.statistics = NULL;
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1)
+        for( size_t t = first_concurrent_task; t < no_of_tasks; t++) {
+                PartitionConfig config = task_config;
+                random_functions::setSeed(seeds[t]);
+                no_of_clusters[t] = solve_task(config, G, &task_nodes[0] + task_start[t], &task_nodes[0] + task_start[t+1],
+                                               component, local_id);
+        }
+        random_functions::setSeed(continuation_seed);
+
+        // the clusters of the tasks follow the trivial components
+        std::vector<PartitionID> cluster_offset(no_of_tasks+1, no_of_trivial);
+        for( size_t t = 0; t < no_of_tasks; t++) {
+                cluster_offset[t+1] = cluster_offset[t] + no_of_clusters[t];
+        }
+
+        #pragma omp parallel for num_threads(num_threads) schedule(static)
+        for( NodeID node = 0; node < n; node++) {
+                NodeID rep = component[node];
+                if( has_negative_edge[rep] ) {
+                        G.setPartitionIndex(node, cluster_offset[component_id[rep]] + G.getPartitionIndex(node));
+                } else {
+                        G.setPartitionIndex(node, component_id[rep]);
+                }
+        }
+
+        partition_config.k = cluster_offset[no_of_tasks];
+        G.set_partition_count(partition_config.k);
+        partition_config.graph_already_partitioned      = true;
+        partition_config.force_new_initial_partitioning = false;
+}
+
+template void positive_component_decomposition::perform_clustering<graph_access>(PartitionConfig & partition_config, graph_access & G);
+template void positive_component_decomposition::perform_clustering<compressed_graph>(PartitionConfig & partition_config, compressed_graph & G);
@@ -0,0 +1,50 @@
+/******************************************************************************
+ * positive_component_decomposition.h
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#ifndef POSITIVE_COMPONENT_DECOMPOSITION_5RJX2W7N
+#define POSITIVE_COMPONENT_DECOMPOSITION_5RJX2W7N
+
+#include <vector>
+
+#include "data_structure/compressed_graph.h"
+#include "data_structure/graph_access.h"
+#include "partition_config.h"
+
+// Clusters a signed graph component by component. The components are the connected components of
+// the positive subgraph (edges with weight > 0). Splitting a cluster along these components only cuts
+// edges with weight <= 0, i.e. it never increases the cut, so the components are solved independently:
+//  - a component without internal negative edges forms a single cluster (optimal, no clustering needed)
+//  - a component with at least config.positive_component_task_size nodes is clustered as its own task
+//  - the remaining components are bundled into tasks of about config.positive_component_task_size nodes
+// The tasks run the multilevel clusterer on their induced subgraphs. The largest task gets all threads
+// if it covers at least half of the nodes of all tasks, the other tasks run concurrently with one
+// thread each. The cluster ids of G are dense afterwards. G is graph_access or compressed_graph, the
+// subgraphs of the tasks are plain graphs.
+class positive_component_decomposition {
+        public:
+                positive_component_decomposition();
+                virtual ~positive_component_decomposition();
+
+                template <typename Graph>
+                void perform_clustering(PartitionConfig & partition_config, Graph & G);
+
+        private:
+                // component of every node, represented by its smallest node
+                template <typename Graph>
+                void compute_components(const PartitionConfig & partition_config, Graph & G,
+                                        std::vector<NodeID> & component);
+
+                // clusters the subgraph induced by nodes (all of them belong to components of the task),
+                // sets the partition indices of the nodes in G to cluster ids 0..k-1 and returns k
+                template <typename Graph>
+                PartitionID solve_task(PartitionConfig & task_config, Graph & G,
+                                       const NodeID * begin, const NodeID * end,
+                                       const std::vector<NodeID> & component,
+                                       std::vector<NodeID> & local_id);
+};
+
+#endif /* end of include guard: POSITIVE_COMPONENT_DECOMPOSITION_5RJX2W7N */
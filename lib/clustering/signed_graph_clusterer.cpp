@@ -4,8 +4,14 @@
 
 #include "coarsening/clustering/size_constraint_label_propagation.h"
 #include "coarsening/coarsening.h"
+#include "uncoarsening/refinement/refinement.h"
 #include "uncoarsening/uncoarsening.h"
+#include "data_structure/clustering_workspace.h"
+#include "kernelization.h"
+#include "pivot_clustering.h"
+#include "positive_component_decomposition.h"
 #include "random_functions.h"
+#include "tools/clustering_statistics.h"
 #include "signed_graph_clusterer.h"
 
 signed_graph_clusterer::signed_graph_clusterer() {
@@ -16,47 +22,142 @@ signed_graph_clusterer::~signed_graph_clusterer() {
 
 }
 
+template <typename Graph>
+bool signed_graph_clusterer::cluster_kernel(PartitionConfig & partition_config, Graph & G) {
+    kernelization kernel;
+    graph_access * reduced = kernel.reduce(partition_config, G);
+    if (!reduced) return false;
+
+    if (reduced->number_of_nodes() > 0) {
+	    PartitionConfig kernel_config = partition_config;
+	    kernel_config.kernelization = false;
+	    perform_signed_clustering(kernel_config, *reduced);
+    }
+    kernel.lift(partition_config, G);
+
+    partition_config.k = G.get_partition_count();
+    partition_config.graph_already_partitioned = true;
+    partition_config.force_new_initial_partitioning = false;
+    return true;
+}
+
 void signed_graph_clusterer::perform_signed_clustering(PartitionConfig & partition_config, graph_access & G) {
+    perform_clustering(partition_config, G);
+}
+
+void signed_graph_clusterer::perform_signed_clustering(PartitionConfig & partition_config, compressed_graph & G) {
+    perform_clustering(partition_config, G);
+}
+
+template <typename Graph>
+void signed_graph_clusterer::perform_clustering(PartitionConfig & partition_config, Graph & G) {
+    if (partition_config.kernelization && cluster_kernel(partition_config, G)) {
+	    return;
+    }
+
+    if (partition_config.positive_component_decomposition) {
+	    positive_component_decomposition decomposition;
+	    decomposition.perform_clustering(partition_config, G);
+	    return;
+    }
+
+    // an input partition is improved by the multilevel algorithm
+    if (partition_config.clustering_engine == CLUSTERING_ENGINE_PIVOT && !partition_config.graph_already_partitioned) {
+	    pivot_clustering pivot;
+	    pivot.perform_clustering(partition_config, G);
+	    return;
+    }
+
+    perform_cycles(partition_config, G);
+}
+
+// the coarser graphs inherit the layout during contraction, a compressed graph always groups its
+// edges by sign
+static void split_edges_by_sign(const PartitionConfig & partition_config, graph_access & G) {
+    if (partition_config.sign_split_adjacency && !G.has_sign_split_edges()) {
+	    G.split_edges_by_sign(partition_config.n_threads);
+    }
+}
+
+static void split_edges_by_sign(const PartitionConfig & partition_config, compressed_graph & G) {
+}
+
+template <typename Graph>
+void signed_graph_clusterer::perform_cycles(PartitionConfig & partition_config, Graph & G) {
     coarsening coarsen;
     uncoarsening uncoarsen;
-    graph_hierarchy hierarchy;
+    refinement refine;
 
     partition_config.kway_adaptive_limits_beta = log(G.number_of_nodes());
     partition_config.k = G.number_of_nodes();
     G.set_partition_count(partition_config.k);
 
+    if (partition_config.statistics) partition_config.statistics->start_run();
+
+    split_edges_by_sign(partition_config, G);
+
+    // scratch memory for all levels of all cycles, sized by the input graph
+    clustering_workspace workspace;
+    workspace.reserve(G.number_of_nodes(), G.number_of_edges(), std::max(1, partition_config.n_threads), partition_config.use_huge_pages);
+    clustering_workspace * outer_workspace = partition_config.workspace;
+    partition_config.workspace = &workspace;
+
     for (int iii=0; iii<partition_config.global_cycle_iterations; iii++) {
-	    // Coarsening
-	    coarsen.perform_coarsening(partition_config, G, hierarchy);
-	    //graph_access & coarsest = *hierarchy.get_coarsest();
-	    /* partition_config.k = G.get_partition_count(); */
-	    /* std::cout << "number of clusters/blocks " << coarsest.number_of_nodes() << std::endl; */
-
-	    // Refinement
-	    if(hierarchy.size() > 1) {
-		    // Graph could be contracted
-		    uncoarsen.perform_uncoarsening(partition_config, hierarchy);
-		    /* partition_config.k = G.get_partition_count(); */
+	    if (partition_config.statistics) partition_config.statistics->start_cycle();
+
+	    // Coarsening, the input graph is contracted into a plain graph that the hierarchy starts with
+	    graph_hierarchy hierarchy;
+	    graph_access* coarser = workspace.acquire_graph();
+	    CoarseMapping coarse_mapping;
+	    if (coarsen.perform_first_level(partition_config, G, *coarser, coarse_mapping)) {
+		    coarsen.perform_coarsening(partition_config, *coarser, hierarchy, 1);
+		    uncoarsen.perform_uncoarsening(partition_config, hierarchy, 1);
+	    } else {
+		    coarsen.initial_clustering(partition_config, *coarser);
+		    if (partition_config.statistics) {
+			    partition_config.statistics->select_level(1, coarser->number_of_nodes(), coarser->number_of_edges());
+		    }
+		    PartitionConfig copy_of_partition_config = partition_config;
+		    refine.perform_refinement(copy_of_partition_config, coarser);
+	    }
+
+	    // Refinement of the input graph
+	    forall_nodes(G, node) {
+		    G.setPartitionIndex(node, coarser->getPartitionIndex(coarse_mapping[node]));
+	    } endfor
+	    G.set_partition_count(coarser->get_partition_count());
+	    workspace.release_graph(coarser);
+
+	    if (partition_config.statistics) {
+		    partition_config.statistics->select_level(0, G.number_of_nodes(), G.number_of_edges());
 	    }
+	    PartitionConfig copy_of_partition_config = partition_config;
+	    refine.perform_refinement(copy_of_partition_config, &G);
 
 	    // In case we continue with cycles
 	    partition_config.graph_already_partitioned = true;
 	    partition_config.force_new_initial_partitioning = false;
 
-	    int k = 0;
-	    std::vector<bool> used_block(G.number_of_nodes(),false);
-	    std::vector<PartitionID> map_old_new(G.number_of_nodes(),0);
-	    forall_nodes(G, n) {
-		    PartitionID old_block = G.getPartitionIndex(n);
-		    if (!used_block[old_block]) {
-			    used_block[old_block] = true;
-			    map_old_new[old_block] = k++;
-		    }
-		    PartitionID new_block = map_old_new[old_block];
-		    G.setPartitionIndex(n, new_block);
-	    } endfor
-	    partition_config.k = k;
-	    G.set_partition_count(partition_config.k);
+	    renumber_clusters(partition_config, G);
     }
+
+    partition_config.workspace = outer_workspace;
 }
 
+template <typename Graph>
+void signed_graph_clusterer::renumber_clusters(PartitionConfig & partition_config, Graph & G) {
+    int k = 0;
+    std::vector<bool> used_block(G.number_of_nodes(),false);
+    std::vector<PartitionID> map_old_new(G.number_of_nodes(),0);
+    forall_nodes(G, n) {
+	    PartitionID old_block = G.getPartitionIndex(n);
+	    if (!used_block[old_block]) {
+		    used_block[old_block] = true;
+		    map_old_new[old_block] = k++;
+	    }
+	    PartitionID new_block = map_old_new[old_block];
+	    G.setPartitionIndex(n, new_block);
+    } endfor
+    partition_config.k = k;
+    G.set_partition_count(partition_config.k);
+}
@@ -6,6 +6,7 @@
 #define KAHIP_SIGNED_GRAPH_CLUSTERER_H
 
 
+#include <data_structure/compressed_graph.h>
 #include <data_structure/graph_access.h>
 #include "partition_config.h"
 
@@ -15,6 +16,28 @@ class signed_graph_clusterer {
         virtual ~signed_graph_clusterer();
 
         void perform_signed_clustering(PartitionConfig & partition_config, graph_access & G);
+
+        // the finest level is clustered, contracted and refined on the compressed graph,
+        // all coarser levels are plain graphs
+        void perform_signed_clustering(PartitionConfig & partition_config, compressed_graph & G);
+
+    private:
+        // selects kernelization, component decomposition, the pivot engine or the multilevel cycles
+        template <typename Graph>
+        void perform_clustering(PartitionConfig & partition_config, Graph & G);
+
+        // the multilevel cycles: the input graph is contracted into a plain graph, the coarser levels are
+        // built and refined by coarsening/uncoarsening, then the input graph is refined
+        template <typename Graph>
+        void perform_cycles(PartitionConfig & partition_config, Graph & G);
+
+        // clusters the kernel of G and lifts the clustering, returns false if no reduction rule applies
+        template <typename Graph>
+        bool cluster_kernel(PartitionConfig & partition_config, Graph & G);
+
+        // numbers the clusters of G consecutively and sets partition_config.k accordingly
+        template <typename Graph>
+        void renumber_clusters(PartitionConfig & partition_config, Graph & G);
 };
 
 
@@ -0,0 +1,123 @@
+/******************************************************************************
+ * cluster_merge_refinement.cpp
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#include <algorithm>
+#include <omp.h>
+
+#include "cluster_merge_refinement.h"
+#include "clustering/coarsening/contraction.h"
+#include "data_structure/clustering_workspace.h"
+#include "data_structure/compressed_graph.h"
+#include "tools/clustering_statistics.h"
+
+const NodeID CLUSTER_MERGE_CHUNK_SIZE = 1024;
+
+cluster_merge_refinement::cluster_merge_refinement() {
+
+}
+
+cluster_merge_refinement::~cluster_merge_refinement() {
+
+}
+
+template <typename Graph>
+EdgeWeight cluster_merge_refinement::perform_refinement(PartitionConfig & partition_config, Graph & G) {
+        const NodeID n        = G.number_of_nodes();
+        const int num_threads = std::max(1, partition_config.n_threads);
+
+        clustering_workspace local_workspace;
+        clustering_workspace & workspace = partition_config.workspace ? *partition_config.workspace : local_workspace;
+
+        // dense cluster ids, the partition indices are below the number of nodes
+        std::vector<NodeID> cluster(n);
+        std::vector<NodeID> dense_id(n, UNDEFINED_NODE);
+        NodeID no_of_clusters = 0;
+        forall_nodes(G, node) {
+                PartitionID block = G.getPartitionIndex(node);
+                if( dense_id[block] == UNDEFINED_NODE ) dense_id[block] = no_of_clusters++;
+                cluster[node] = dense_id[block];
+        } endfor
+
+        // the quotient graph needs neither the sign split layout nor the second partition
+        PartitionConfig quotient_config      = partition_config;
+        quotient_config.sign_split_adjacency = false;
+        quotient_config.combine              = false;
+
+        contraction contracter;
+        graph_access * Q = workspace.acquire_graph();
+        contracter.contract_clustering(quotient_config, G, *Q, cluster, no_of_clusters);
+
+        EdgeWeight improvement = 0;
+        NodeID merges          = 0;
+        std::vector<NodeID> partner;
+        std::vector<EdgeWeight> partner_weight;
+        CoarseMapping mapping;
+        for( int round = 0; round < partition_config.cluster_merge_rounds; round++) {
+                const NodeID q = Q->number_of_nodes();
+                partner.assign(q, UNDEFINED_NODE);
+                partner_weight.assign(q, 0);
+
+                #pragma omp parallel for num_threads(num_threads) schedule(dynamic, CLUSTER_MERGE_CHUNK_SIZE)
+                for( NodeID c = 0; c < q; c++) {
+                        forall_neighbors((*Q), it, c) {
+                                if( it.weight() > partner_weight[c]
+                                 || (it.weight() == partner_weight[c] && it.weight() > 0 && it.target() < partner[c]) ) {
+                                        partner[c]        = it.target();
+                                        partner_weight[c] = it.weight();
+                                }
+                        } endfor
+                }
+
+                // pairs that propose to each other are merged
+                mapping.assign(q, UNDEFINED_NODE);
+                NodeID no_of_merged_clusters = 0;
+                NodeID round_merges          = 0;
+                for( NodeID c = 0; c < q; c++) {
+                        if( mapping[c] != UNDEFINED_NODE ) continue;
+                        mapping[c] = no_of_merged_clusters++;
+
+                        NodeID d = partner[c];
+                        if( d != UNDEFINED_NODE && partner[d] == c ) {
+                                mapping[d]   = mapping[c];
+                                improvement += partner_weight[c];
+                                round_merges++;
+                        }
+                }
+                if( round_merges == 0 ) break;
+                merges        += round_merges;
+                no_of_clusters = no_of_merged_clusters;
+
+                #pragma omp parallel for num_threads(num_threads) schedule(static)
+                for( NodeID node = 0; node < n; node++) {
+                        cluster[node] = mapping[cluster[node]];
+                }
+
+                graph_access * coarser = workspace.acquire_graph();
+                contracter.contract_clustering(quotient_config, *Q, *coarser, mapping, no_of_merged_clusters);
+                workspace.release_graph(Q);
+                Q = coarser;
+        }
+        workspace.release_graph(Q);
+
+        if( merges > 0 ) {
+                #pragma omp parallel for num_threads(num_threads) schedule(static)
+                for( NodeID node = 0; node < n; node++) {
+                        G.setPartitionIndex(node, cluster[node]);
+                }
+                // the merged cluster ids are dense
+                G.set_partition_count(no_of_clusters);
+                partition_config.k = no_of_clusters;
+        }
+
+        if( partition_config.statistics ) {
+                partition_config.statistics->current().cluster_merges += merges;
+        }
+        return improvement;
+}
+
+template EdgeWeight cluster_merge_refinement::perform_refinement<graph_access>(PartitionConfig & partition_config, graph_access & G);
+template EdgeWeight cluster_merge_refinement::perform_refinement<compressed_graph>(PartitionConfig & partition_config, compressed_graph & G);
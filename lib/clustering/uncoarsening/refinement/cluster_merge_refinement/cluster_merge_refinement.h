@@ -0,0 +1,30 @@
+/******************************************************************************
+ * cluster_merge_refinement.h
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#ifndef CLUSTER_MERGE_REFINEMENT_K7TD4X9B
+#define CLUSTER_MERGE_REFINEMENT_K7TD4X9B
+
+#include "definitions.h"
+#include "../refinement.h"
+
+// Merges whole clusters. The quotient graph of the clustering is built by the parallel contraction,
+// then every cluster proposes to its adjacent cluster of heaviest positive aggregate weight and pairs
+// that propose to each other are merged (a matching, so every merge decreases the cut by the weight
+// between the two clusters). The quotient graph is contracted by the matching and the next round
+// starts, up to config.cluster_merge_rounds rounds or until no pair is merged.
+class cluster_merge_refinement : public refinement {
+public:
+        cluster_merge_refinement();
+        virtual ~cluster_merge_refinement();
+
+        // Graph is graph_access or compressed_graph, returns the decrease of the cut
+        template <typename Graph>
+        EdgeWeight perform_refinement(PartitionConfig & config, Graph & G);
+};
+
+
+#endif /* end of include guard: CLUSTER_MERGE_REFINEMENT_K7TD4X9B */
@@ -0,0 +1,239 @@
+/******************************************************************************
+ * kway_gain_cache.h
+ *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#ifndef KWAY_GAIN_CACHE_H5VB0LQE
+#define KWAY_GAIN_CACHE_H5VB0LQE
+
+#include <limits>
+#include <vector>
+
+#include "data_structure/graph_access.h"
+#include "definitions.h"
+#include "random_functions.h"
+
+// Stores for every node the summed edge weight (and the number of edges) to each adjacent cluster.
+// A move of a node updates the entries of its neighbors in O(deg), the gain of a node is then computed
+// from its entries without touching its adjacency or the partition indices of its neighbors.
+// Every node owns an open addressing segment of 2*(deg+1) slots. Entries whose edge count drops to zero
+// stay in the segment (so probing sequences remain valid), a segment is compacted once it runs full.
+// The best external cluster of every node, its weight and the internal weight are kept up to date by
+// add/remove, so compute_gain is O(1). Only if the best entry of a node decreases (or the node itself
+// moves) its segment is rescanned, lazily by the next compute_gain.
+class kway_gain_cache {
+        public:
+                kway_gain_cache() {};
+                virtual ~kway_gain_cache() {};
+
+                void initialize(graph_access & G);
+
+                // has to be called for every change of a partition index, rollbacks included
+                inline void move_node(graph_access & G, NodeID node, PartitionID from, PartitionID to);
+
+                // same semantics as kway_graph_refinement_commons::compute_gain
+                inline Gain compute_gain(graph_access & G,
+                                         NodeID & node,
+                                         PartitionID & max_gainer,
+                                         EdgeWeight & ext_degree);
+
+                size_t memory_in_bytes() const {
+                        return m_entries.capacity()*sizeof(cache_entry) + m_used.capacity()*sizeof(NodeID)
+                               + m_best.capacity()*sizeof(node_summary) + m_stale.capacity();
+                };
+
+                // memory that a cache for G would need, used to decide whether to enable it
+                static size_t memory_in_bytes(graph_access & G) {
+                        return 2*((size_t)G.number_of_edges() + G.number_of_nodes())*sizeof(cache_entry)
+                               + (size_t)G.number_of_nodes()*(sizeof(NodeID) + sizeof(node_summary) + 1);
+                };
+
+        private:
+                struct cache_entry {
+                        PartitionID block;
+                        unsigned    count;
+                        EdgeWeight  weight;
+                };
+
+                struct node_summary {
+                        PartitionID best_block;  // INVALID_PARTITION if there is no external cluster
+                        EdgeWeight  best_weight;
+                        EdgeWeight  internal_weight;
+                };
+
+                inline size_t segment_begin(graph_access & G, NodeID node) {
+                        return 2*((size_t)G.get_first_edge(node) + node);
+                };
+
+                inline size_t segment_size(graph_access & G, NodeID node) {
+                        return 2*((size_t)G.getNodeDegree(node) + 1);
+                };
+
+                inline size_t find_slot(size_t begin, size_t size, PartitionID block) {
+                        size_t pos = (size_t)block % size;
+                        while( m_entries[begin+pos].block != INVALID_PARTITION && m_entries[begin+pos].block != block ) {
+                                pos = pos + 1 == size ? 0 : pos + 1;
+                        }
+                        return begin+pos;
+                };
+
+                inline void add(graph_access & G, NodeID node, PartitionID block, EdgeWeight weight);
+                inline void remove(graph_access & G, NodeID node, PartitionID block, EdgeWeight weight);
+                inline void update_summary(graph_access & G, NodeID node, const cache_entry & entry, bool increased);
+                inline void rescan(graph_access & G, NodeID node);
+                void compact(graph_access & G, NodeID node);
+
+                std::vector<cache_entry>   m_entries;
+                std::vector<NodeID>        m_used;  // occupied slots per segment, stale entries included
+                std::vector<cache_entry>   m_scratch;
+                std::vector<node_summary>  m_best;
+                std::vector<unsigned char> m_stale; // m_best of the node has to be recomputed
+};
+
+inline void kway_gain_cache::initialize(graph_access & G) {
+        cache_entry empty;
+        empty.block  = INVALID_PARTITION;
+        empty.count  = 0;
+        empty.weight = 0;
+
+        m_entries.assign(2*((size_t)G.number_of_edges() + G.number_of_nodes()), empty);
+        m_used.assign(G.number_of_nodes(), 0);
+        m_best.resize(G.number_of_nodes());
+        m_stale.assign(G.number_of_nodes(), 1);
+
+        forall_nodes(G, node) {
+                forall_out_edges(G, e, node) {
+                        add(G, node, G.getPartitionIndex(G.getEdgeTarget(e)), G.getEdgeWeight(e));
+                } endfor
+        } endfor
+}
+
+inline void kway_gain_cache::move_node(graph_access & G, NodeID node, PartitionID from, PartitionID to) {
+        if( from == to ) return;
+
+        // the internal and the external clusters of the node itself change
+        m_stale[node] = 1;
+
+        forall_out_edges(G, e, node) {
+                NodeID target     = G.getEdgeTarget(e);
+                EdgeWeight weight = G.getEdgeWeight(e);
+                remove(G, target, from, weight);
+                add(G, target, to, weight);
+        } endfor
+}
+
+inline void kway_gain_cache::add(graph_access & G, NodeID node, PartitionID block, EdgeWeight weight) {
+        size_t begin = segment_begin(G, node);
+        size_t size  = segment_size(G, node);
+        size_t pos   = find_slot(begin, size, block);
+
+        if( m_entries[pos].block == INVALID_PARTITION ) {
+                // keep at least one free slot so that probing terminates
+                if( m_used[node] + 2 > size ) {
+                        compact(G, node);
+                        pos = find_slot(begin, size, block);
+                }
+                m_entries[pos].block = block;
+                m_used[node]++;
+        }
+
+        m_entries[pos].weight += weight;
+        m_entries[pos].count++;
+        update_summary(G, node, m_entries[pos], weight >= 0);
+}
+
+inline void kway_gain_cache::remove(graph_access & G, NodeID node, PartitionID block, EdgeWeight weight) {
+        size_t pos = find_slot(segment_begin(G, node), segment_size(G, node), block);
+        ASSERT_EQ(m_entries[pos].block, block);
+
+        m_entries[pos].weight -= weight;
+        m_entries[pos].count--;
+        update_summary(G, node, m_entries[pos], weight <= 0 && m_entries[pos].count > 0);
+}
+
+// entry has just changed, increased tells whether its weight did not decrease and it is still used
+inline void kway_gain_cache::update_summary(graph_access & G, NodeID node, const cache_entry & entry, bool increased) {
+        if( m_stale[node] ) return;
+
+        node_summary & summary = m_best[node];
+        if( entry.block == G.getPartitionIndex(node) ) {
+                summary.internal_weight = entry.count > 0 ? entry.weight : 0;
+        } else if( entry.block == summary.best_block ) {
+                if( increased ) {
+                        summary.best_weight = entry.weight;
+                } else {
+                        m_stale[node] = 1;
+                }
+        } else if( entry.count > 0 && (summary.best_block == INVALID_PARTITION || entry.weight > summary.best_weight) ) {
+                summary.best_block  = entry.block;
+                summary.best_weight = entry.weight;
+        }
+}
+
+inline void kway_gain_cache::rescan(graph_access & G, NodeID node) {
+	random_functions::fastRandBool<uint64_t> random_obj;
+        PartitionID source_partition = G.getPartitionIndex(node);
+        node_summary & summary       = m_best[node];
+        summary.best_block           = INVALID_PARTITION;
+        summary.best_weight          = std::numeric_limits<EdgeWeight>::min();
+        summary.internal_weight      = 0;
+
+        size_t begin = segment_begin(G, node);
+        size_t end   = begin + segment_size(G, node);
+        for( size_t i = begin; i < end; i++) {
+                const cache_entry & entry = m_entries[i];
+                if( entry.count == 0 ) continue;
+
+                if( entry.block == source_partition ) {
+                        summary.internal_weight = entry.weight;
+                } else if( entry.weight > summary.best_weight ) {
+                        summary.best_weight = entry.weight;
+                        summary.best_block  = entry.block;
+                } else if( entry.weight == summary.best_weight && random_obj.nextBool() ) {
+                        //break ties randomly
+                        summary.best_block = entry.block;
+                }
+        }
+        m_stale[node] = 0;
+}
+
+inline void kway_gain_cache::compact(graph_access & G, NodeID node) {
+        size_t begin = segment_begin(G, node);
+        size_t size  = segment_size(G, node);
+
+        m_scratch.clear();
+        for( size_t i = begin; i < begin + size; i++) {
+                if( m_entries[i].count > 0 ) {
+                        m_scratch.push_back(m_entries[i]);
+                }
+                m_entries[i].block  = INVALID_PARTITION;
+                m_entries[i].count  = 0;
+                m_entries[i].weight = 0;
+        }
+
+        for( size_t i = 0; i < m_scratch.size(); i++) {
+                m_entries[find_slot(begin, size, m_scratch[i].block)] = m_scratch[i];
+        }
+        m_used[node] = m_scratch.size();
+}
+
+inline Gain kway_gain_cache::compute_gain(graph_access & G,
+                                          NodeID & node,
+                                          PartitionID & max_gainer,
+                                          EdgeWeight & ext_degree) {
+        if( m_stale[node] ) rescan(G, node);
+
+        const node_summary & summary = m_best[node];
+        max_gainer                   = summary.best_block;
+        EdgeWeight max_degree        = 0;
+        if(max_gainer != INVALID_PARTITION) {
+                max_degree = summary.best_weight;
+        }
+        ext_degree = max_degree;
+
+        return max_degree - summary.internal_weight;
+}
+
+#endif /* end of include guard: KWAY_GAIN_CACHE_H5VB0LQE */
@@ -8,6 +8,8 @@
 #include <algorithm>
 #include <unordered_map>
 
+#include "data_structure/clustering_workspace.h"
+#include "data_structure/compressed_graph.h"
 #include "kway_graph_refinement.h"
 #include "kway_graph_refinement_core.h"
 #include "kway_stop_rule.h"
@@ -15,13 +17,23 @@
 #include "random_functions.h"
 #include "timer.h"
 
+// the gain cache addresses the adjacency by edge ids, i.e. it is only available for graph_access
+static void attach_gain_cache(graph_access & G, kway_gain_cache & gain_cache, kway_graph_refinement_core & refinement_core) {
+        gain_cache.initialize(G);
+        refinement_core.set_gain_cache(&gain_cache);
+}
+
+static void attach_gain_cache(compressed_graph & G, kway_gain_cache & gain_cache, kway_graph_refinement_core & refinement_core) {
+}
+
 kway_graph_refinement::kway_graph_refinement() {
 }
 
 kway_graph_refinement::~kway_graph_refinement() {
 }
 
-EdgeWeight kway_graph_refinement::perform_refinement(PartitionConfig & config, graph_access & G) {
+template <typename Graph>
+EdgeWeight kway_graph_refinement::perform_refinement(PartitionConfig & config, Graph & G) {
 
         kway_graph_refinement_core refinement_core;
         
@@ -29,7 +41,15 @@ EdgeWeight kway_graph_refinement::perform_refinement(PartitionConfig & config, g
         int max_number_of_swaps        = (int)(G.number_of_nodes());
         bool sth_changed               = config.no_change_convergence;
 
-        vertex_moved_hashtable moved_idx(G.number_of_nodes()); 
+        clustering_workspace local_workspace;
+        vertex_moved_hashtable & moved_idx = config.workspace ? config.workspace->moved_idx : local_workspace.moved_idx;
+        moved_idx.resize(G.number_of_nodes());
+
+        kway_gain_cache gain_cache;
+        if(config.kway_gain_cache) {
+                attach_gain_cache(G, gain_cache, refinement_core);
+        }
+
         for( unsigned i = 0; i < config.kway_rounds || sth_changed; i++) {
                 EdgeWeight improvement = 0;    
 
@@ -42,7 +62,7 @@ EdgeWeight kway_graph_refinement::perform_refinement(PartitionConfig & config, g
                 //metis steplimit
                 int step_limit = (int)((config.kway_fm_search_limit/100.0)*max_number_of_swaps);
                 step_limit = std::max(step_limit, 15);
-                step_limit = 15; // CS hard parameter default
+                step_limit = config.kway_fm_step_limit; // CS hard parameter, default 15
 
                 improvement += refinement_core.single_kway_refinement_round(config, G,  
                                                                             start_nodes, step_limit, 
@@ -74,11 +94,12 @@ EdgeWeight kway_graph_refinement::perform_refinement(PartitionConfig & config, g
         return (EdgeWeight) overall_improvement; 
 }
 
-void kway_graph_refinement::setup_start_nodes(PartitionConfig & config, graph_access & G,  boundary_starting_nodes & start_nodes) {
+template <typename Graph>
+void kway_graph_refinement::setup_start_nodes(PartitionConfig & config, Graph & G,  boundary_starting_nodes & start_nodes) {
         forall_nodes(G, node) {
                 PartitionID block = G.getPartitionIndex(node);
-                forall_out_edges(G, e, node) {
-                        NodeID target = G.getEdgeTarget(e);
+                forall_neighbors(G, it, node) {
+                        NodeID target = it.target();
                         if( G.getPartitionIndex(target) != block) {
                                 start_nodes.push_back(node);
                                 break;
@@ -120,3 +141,6 @@ void kway_graph_refinement::setup_start_nodes(PartitionConfig & config, graph_ac
 }
 
 
+
+template EdgeWeight kway_graph_refinement::perform_refinement<graph_access>(PartitionConfig & config, graph_access & G);
+template EdgeWeight kway_graph_refinement::perform_refinement<compressed_graph>(PartitionConfig & config, compressed_graph & G);
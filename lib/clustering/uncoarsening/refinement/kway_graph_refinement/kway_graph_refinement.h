@@ -22,11 +22,14 @@ class kway_graph_refinement {
                 kway_graph_refinement( );
                 virtual ~kway_graph_refinement();
 
+                // Graph is graph_access or compressed_graph
+                template <typename Graph>
                 EdgeWeight perform_refinement(PartitionConfig & config, 
-                                              graph_access & G);
+                                              Graph & G);
 
+                template <typename Graph>
                 void setup_start_nodes(PartitionConfig & config, 
-                                       graph_access & G, 
+                                       Graph & G, 
                                        boundary_starting_nodes & start_nodes);
 };
 
@@ -26,7 +26,9 @@ class kway_graph_refinement_commons  {
 
                 bool incident_to_more_than_two_partitions(graph_access & G, NodeID & node);
 
-                EdgeWeight compute_gain(graph_access & G, 
+                // Graph is graph_access or compressed_graph
+                template <typename Graph>
+                EdgeWeight compute_gain(Graph & G, 
                                         NodeID & node, 
                                         PartitionID & max_gainer, 
                                         EdgeWeight & ext_degree);
@@ -120,7 +122,8 @@ inline bool kway_graph_refinement_commons::int_ext_degree( graph_access & G,
         return update_is_difficult;
 }
 
-inline Gain kway_graph_refinement_commons::compute_gain(graph_access & G, 
+template <typename Graph>
+inline Gain kway_graph_refinement_commons::compute_gain(Graph & G, 
                                                         NodeID & node, 
                                                         PartitionID & max_gainer, 
                                                         EdgeWeight & ext_degree) {
@@ -132,21 +135,21 @@ inline Gain kway_graph_refinement_commons::compute_gain(graph_access & G,
         max_gainer                   = INVALID_PARTITION;
 
         m_round++;//can become zero again
-        forall_out_edges(G, e, node) {
-                NodeID target                = G.getEdgeTarget(e);
+        forall_neighbors(G, it, node) {
+                NodeID target                = it.target();
                 PartitionID target_partition = G.getPartitionIndex(target);
 
                 if(m_local_degrees[target_partition].round == m_round) {
-                        m_local_degrees[target_partition].local_degree += G.getEdgeWeight(e);
+                        m_local_degrees[target_partition].local_degree += it.weight();
                 } else {
-                        m_local_degrees[target_partition].local_degree = G.getEdgeWeight(e);
+                        m_local_degrees[target_partition].local_degree = it.weight();
                         m_local_degrees[target_partition].round = m_round;
                 }
         } endfor
 
 
-        forall_out_edges(G, e, node) {
-                NodeID target                = G.getEdgeTarget(e);
+        forall_neighbors(G, it, node) {
+                NodeID target                = it.target();
                 PartitionID target_partition = G.getPartitionIndex(target);
                 if(m_local_degrees[target_partition].local_degree >= max_degree && target_partition != source_partition) {
                         if(m_local_degrees[target_partition].local_degree > max_degree) {
@@ -7,15 +7,17 @@
 
 #include <algorithm>
 
+#include "data_structure/compressed_graph.h"
 #include "data_structure/priority_queues/bucket_pq.h"
 #include "data_structure/priority_queues/maxNodeHeap.h"
 #include "kway_graph_refinement_core.h"
 #include "kway_stop_rule.h"
+#include "clustering_statistics.h"
 #include "quality_metrics.h"
 #include "random_functions.h"
 #include "timer.h"
 
-kway_graph_refinement_core::kway_graph_refinement_core() : commons (NULL){
+kway_graph_refinement_core::kway_graph_refinement_core() : commons (NULL), m_gain_cache (NULL) {
 }
 
 kway_graph_refinement_core::~kway_graph_refinement_core() {
@@ -32,19 +34,23 @@ kway_graph_refinement_core::~kway_graph_refinement_core() {
                                                      //step_limit, moved_idx, false );
 //}
 
+template <typename Graph>
 EdgeWeight kway_graph_refinement_core::single_kway_refinement_round(PartitionConfig & config, 
-                                                                    graph_access & G, 
+                                                                    Graph & G, 
                                                                     boundary_starting_nodes & start_nodes, 
                                                                     int step_limit, 
                                                                     vertex_moved_hashtable & moved_idx) {
 
-        return single_kway_refinement_round_internal(config, G, start_nodes, 
-                                                     step_limit, moved_idx, true );
+        // the clustering always searches with the simple stop rule. the queue and the stop rule are
+        // template parameters of the search so that their calls are resolved at compile time
+        return single_kway_refinement_round_internal<Graph, maxNodeHeap, kway_simple_stop_rule>(config, G, start_nodes, 
+                                                                                               step_limit, moved_idx, true );
 }
 
 
+template <typename Graph, typename PQ, typename StopRule>
 EdgeWeight kway_graph_refinement_core::single_kway_refinement_round_internal(PartitionConfig & config, 
-                                                                    graph_access & G, 
+                                                                    Graph & G, 
                                                                     boundary_starting_nodes & start_nodes, 
                                                                     int step_limit,
                                                                     vertex_moved_hashtable & moved_idx,
@@ -52,11 +58,11 @@ EdgeWeight kway_graph_refinement_core::single_kway_refinement_round_internal(Par
 
         if( commons == NULL ) commons = new kway_graph_refinement_commons(config);
 
-        refinement_pq* queue = new maxNodeHeap(); 
+        PQ queue; 
       
         init_queue_with_boundary(config, G, start_nodes, queue, moved_idx);  
         
-        if(queue->empty()) {delete queue; return 0;}
+        if(queue.empty()) return 0;
 
         std::vector<NodeID> transpositions;
         std::vector<PartitionID> from_partitions;
@@ -73,29 +79,29 @@ EdgeWeight kway_graph_refinement_core::single_kway_refinement_round_internal(Par
         int number_of_swaps = 0;
         int movements       = 0;
 
-        kway_stop_rule* stopping_rule = new kway_simple_stop_rule(config);
+        StopRule stopping_rule(config);
 
         for(number_of_swaps = 0, movements = 0; movements < max_number_of_swaps; movements++, number_of_swaps++) {
-                if( queue->empty() ) break;
-                if( stopping_rule->search_should_stop(min_cut_index, number_of_swaps, step_limit) ) {
+                if( queue.empty() ) break;
+                if( stopping_rule.search_should_stop(min_cut_index, number_of_swaps, step_limit) ) {
                         break;
                 }
 
-                Gain gain = queue->maxValue();
-                NodeID node = queue->deleteMax();
+                Gain gain = queue.maxValue();
+                NodeID node = queue.deleteMax();
 
                 PartitionID from = G.getPartitionIndex(node); 
                 bool successfull = move_node(config, G, node, moved_idx, queue);
 
                 if(successfull) {
                         cut -= gain;
-                        stopping_rule->push_statistics(gain);
+                        stopping_rule.push_statistics(gain);
 
                         if( cut <= best_cut) {
                                 best_cut = cut;
                                 min_cut_index = number_of_swaps;
                                 if(cut < best_cut)
-                                        stopping_rule->reset_statistics();
+                                        stopping_rule.reset_statistics();
                         }
 
                         from_partitions.push_back(from);
@@ -108,6 +114,11 @@ EdgeWeight kway_graph_refinement_core::single_kway_refinement_round_internal(Par
 
         } 
 
+        if( config.statistics ) {
+                config.statistics->current().kway_moves     += transpositions.size();
+                config.statistics->current().kway_rollbacks += transpositions.size() - (min_cut_index + 1);
+        }
+
         //roll backwards
         for(number_of_swaps--; number_of_swaps>min_cut_index; number_of_swaps--) {
                 ASSERT_TRUE(transpositions.size() > 0);
@@ -122,16 +133,15 @@ EdgeWeight kway_graph_refinement_core::single_kway_refinement_round_internal(Par
                 move_node_back(config, G, node, to,  moved_idx, queue);
         }
 
-       
-        delete queue;
-        delete stopping_rule;
+
         return initial_cut - best_cut; 
 }
 
+template <typename Graph, typename PQ>
 void kway_graph_refinement_core::init_queue_with_boundary(const PartitionConfig & config,
-                graph_access & G,
+                Graph & G,
                 std::vector<NodeID> & bnd_nodes,
-                refinement_pq * queue, vertex_moved_hashtable & moved_idx) {
+                PQ & queue, vertex_moved_hashtable & moved_idx) {
 
         random_functions::permutate_vector_fast(bnd_nodes, false);
 
@@ -140,22 +150,31 @@ void kway_graph_refinement_core::init_queue_with_boundary(const PartitionConfig
                 PartitionID max_gainer;
                 EdgeWeight ext_degree;
                 //compute gain
-                Gain gain = commons->compute_gain(G, node, max_gainer, ext_degree);
-                queue->insert(node, gain);
+                Gain gain = compute_gain(G, node, max_gainer, ext_degree);
+                queue.insert(node, gain);
                 moved_idx[node].index = NOT_MOVED;
         }
 }
 
 
+template <typename Graph, typename PQ>
 void kway_graph_refinement_core::move_node_back(PartitionConfig & config, 
-                graph_access & G, 
+                Graph & G, 
                 NodeID & node,
                 PartitionID & to, 
                 vertex_moved_hashtable & moved_idx, 
-                refinement_pq * queue) {
+                PQ & queue) {
 
-        //PartitionID from = G.getPartitionIndex(node);
+        PartitionID from = G.getPartitionIndex(node);
         G.setPartitionIndex(node, to);        
+        update_gain_cache(G, node, from, to);
         //moved_idx[node].index = NOT_MOVED;
 }
 
+
+template EdgeWeight kway_graph_refinement_core::single_kway_refinement_round<graph_access>(PartitionConfig & config, graph_access & G,
+                                                                                          boundary_starting_nodes & start_nodes, int step_limit,
+                                                                                          vertex_moved_hashtable & moved_idx);
+template EdgeWeight kway_graph_refinement_core::single_kway_refinement_round<compressed_graph>(PartitionConfig & config, compressed_graph & G,
+                                                                                              boundary_starting_nodes & start_nodes, int step_limit,
+                                                                                              vertex_moved_hashtable & moved_idx);
@@ -13,6 +13,7 @@
 
 #include "data_structure/priority_queues/priority_queue_interface.h"
 #include "definitions.h"
+#include "kway_gain_cache.h"
 #include "kway_graph_refinement_commons.h"
 #include "tools/random_functions.h"
 #include "clustering/uncoarsening/refinement/quotient_graph_refinement/2way_fm_refinement/vertex_moved_hashtable.h"
@@ -23,12 +24,19 @@ class kway_graph_refinement_core  {
                 kway_graph_refinement_core( );
                 virtual ~kway_graph_refinement_core();
 
+                // Graph is graph_access or compressed_graph
+                template <typename Graph>
                 EdgeWeight single_kway_refinement_round(PartitionConfig & config, 
-                                                        graph_access & G, 
+                                                        Graph & G, 
                                                         boundary_starting_nodes & start_nodes, 
                                                         int step_limit, 
                                                         vertex_moved_hashtable & moved_idx );
 
+                // if set, gains are taken from the cache, which is kept up to date by all moves of the core
+                void set_gain_cache(kway_gain_cache * gain_cache) {
+                        m_gain_cache = gain_cache;
+                }
+
                 //EdgeWeight single_kway_refinement_round(PartitionConfig & config, 
                                                         //graph_access & G, 
                                                         //complete_boundary & boundary, 
@@ -38,72 +46,117 @@ class kway_graph_refinement_core  {
 
 
          private:
+               // PQ and StopRule are concrete (final) classes, i.e. their calls are not virtual
+               template <typename Graph, typename PQ, typename StopRule>
                EdgeWeight single_kway_refinement_round_internal(PartitionConfig & config, 
-                                                                graph_access & G, 
+                                                                Graph & G, 
                                                                 boundary_starting_nodes & start_nodes, 
                                                                 int step_limit,
                                                                 vertex_moved_hashtable & moved_idx,
                                                                 bool compute_touched_partitions); 
 
 
+                template <typename Graph, typename PQ>
                 void init_queue_with_boundary(const PartitionConfig & config, 
-                                              graph_access & G, 
+                                              Graph & G, 
                                               std::vector<NodeID> & bnd_nodes, 
-                                              refinement_pq * queue, 
+                                              PQ & queue, 
                                               vertex_moved_hashtable & moved_idx);
 
+                template <typename Graph, typename PQ>
                 inline bool move_node(PartitionConfig & config, 
-                                      graph_access & G, 
+                                      Graph & G, 
                                       NodeID & node, 
                                       vertex_moved_hashtable & moved_idx, 
-                                      refinement_pq * queue);
+                                      PQ & queue);
 
+                template <typename Graph, typename PQ>
                 inline void move_node_back(PartitionConfig & config, 
-                                           graph_access & G, 
+                                           Graph & G, 
                                            NodeID & node,
                                            PartitionID & to, 
                                            vertex_moved_hashtable & moved_idx, 
-                                           refinement_pq * queue);
+                                           PQ & queue);
 
                 void initialize_partition_moves_array(PartitionConfig & config, 
                                                       std::vector<bool> & partition_move_valid); 
+
+                template <typename Graph>
+                inline Gain compute_gain(Graph & G, 
+                                         NodeID & node, 
+                                         PartitionID & max_gainer, 
+                                         EdgeWeight & ext_degree);
+                inline Gain compute_gain(graph_access & G, 
+                                         NodeID & node, 
+                                         PartitionID & max_gainer, 
+                                         EdgeWeight & ext_degree);
+
+                // the gain cache addresses the adjacency by edge ids, i.e. it is only used for graph_access
+                template <typename Graph>
+                inline void update_gain_cache(Graph & G, NodeID node, PartitionID from, PartitionID to) {};
+                inline void update_gain_cache(graph_access & G, NodeID node, PartitionID from, PartitionID to);
                 
                 kway_graph_refinement_commons* commons;
+                kway_gain_cache* m_gain_cache;
 };
 
+template <typename Graph>
+inline Gain kway_graph_refinement_core::compute_gain(Graph & G, 
+                                                     NodeID & node, 
+                                                     PartitionID & max_gainer, 
+                                                     EdgeWeight & ext_degree) {
+        return commons->compute_gain(G, node, max_gainer, ext_degree);
+}
+
+inline Gain kway_graph_refinement_core::compute_gain(graph_access & G, 
+                                                     NodeID & node, 
+                                                     PartitionID & max_gainer, 
+                                                     EdgeWeight & ext_degree) {
+        if( m_gain_cache != NULL ) {
+                return m_gain_cache->compute_gain(G, node, max_gainer, ext_degree);
+        }
+        return commons->compute_gain(G, node, max_gainer, ext_degree);
+}
+
+inline void kway_graph_refinement_core::update_gain_cache(graph_access & G, NodeID node, PartitionID from, PartitionID to) {
+        if( m_gain_cache != NULL ) m_gain_cache->move_node(G, node, from, to);
+}
+
+template <typename Graph, typename PQ>
 inline bool kway_graph_refinement_core::move_node(PartitionConfig & config, 
-                graph_access & G, 
+                Graph & G, 
                 NodeID & node, 
                 vertex_moved_hashtable & moved_idx, 
-                refinement_pq * queue) {
+                PQ & queue) {
 
 
-        //PartitionID from = G.getPartitionIndex(node);
+        PartitionID from = G.getPartitionIndex(node);
         PartitionID to;
         EdgeWeight node_ext_deg;
-        commons->compute_gain(G, node, to, node_ext_deg);
+        compute_gain(G, node, to, node_ext_deg);
         //NodeWeight this_nodes_weight = G.getNodeWeight(node);
 
         G.setPartitionIndex(node, to);        
+        update_gain_cache(G, node, from, to);
 
         //update gain of neighbors / the boundaries have already been updated
-        forall_out_edges(G, e, node) {
-                NodeID target = G.getEdgeTarget(e);
+        forall_neighbors(G, it, node) {
+                NodeID target = it.target();
                 PartitionID targets_max_gainer;
                 EdgeWeight ext_degree; // the local external degree
-                Gain gain = commons->compute_gain(G, target, targets_max_gainer, ext_degree);
+                Gain gain = compute_gain(G, target, targets_max_gainer, ext_degree);
 
-                if(queue->contains(target)) {
+                if(queue.contains(target)) {
                         if(targets_max_gainer != INVALID_PARTITION) { // is boundary node? // before signed clustering: ext_degree > 0
-                                queue->changeKey(target, gain);
+                                queue.changeKey(target, gain);
                         } else {
-                                queue->deleteNode(target);
+                                queue.deleteNode(target);
                         }
                 } else {
                         if(targets_max_gainer != INVALID_PARTITION) { // is boundary node? // before signed clustering: ext_degree > 0
                                 if(moved_idx[target].index == NOT_QUEUED) {
                                 //if(moved_idx.find(target) == moved_idx.end()) {
-                                        queue->insert(target, gain);
+                                        queue.insert(target, gain);
                                         moved_idx[target].index = NOT_MOVED;
                                 } 
                         } 
@@ -21,7 +21,7 @@ public:
                                         unsigned int search_limit) = 0;
 };
 
-class kway_simple_stop_rule : public kway_stop_rule {
+class kway_simple_stop_rule final : public kway_stop_rule {
 public:
         kway_simple_stop_rule(PartitionConfig & config) {};
         virtual ~kway_simple_stop_rule() {};
@@ -40,7 +40,7 @@ inline bool kway_simple_stop_rule::search_should_stop(unsigned int min_cut_idx,
 }
 
 
-class kway_adaptive_stop_rule : public kway_stop_rule {
+class kway_adaptive_stop_rule final : public kway_stop_rule {
 public:
         kway_adaptive_stop_rule(PartitionConfig & config) : m_steps(0), 
                                                             m_expected_gain(0.0), 
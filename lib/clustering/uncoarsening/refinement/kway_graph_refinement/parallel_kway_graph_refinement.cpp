@@ -0,0 +1,418 @@
+/******************************************************************************
+ * parallel_kway_graph_refinement.cpp 
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#include <algorithm>
+#include <limits>
+#include <omp.h>
+
+#include "parallel_kway_graph_refinement.h"
+#include "clustering_statistics.h"
+#include "kway_stop_rule.h"
+#include "random_functions.h"
+
+const NodeID LOCKED_NODE      = std::numeric_limits<NodeID>::max();
+const EdgeID NOT_IN_LOG       = std::numeric_limits<EdgeID>::max();
+const NodeID PARALLEL_FM_CHUNK_SIZE = 1024;
+const EdgeWeight NO_CANDIDATE       = std::numeric_limits<EdgeWeight>::min();
+
+parallel_kway_graph_refinement::parallel_kway_graph_refinement() : m_log_size(0), m_global_rollbacks(0), m_num_threads(1), 
+                                                                   m_deterministic(false), m_round_seed(0) {
+}
+
+parallel_kway_graph_refinement::~parallel_kway_graph_refinement() {
+}
+
+EdgeWeight parallel_kway_graph_refinement::perform_refinement(PartitionConfig & config, graph_access & G) {
+        NodeID n        = G.number_of_nodes();
+        m_num_threads   = std::max(1, config.n_threads);
+        m_deterministic = config.deterministic;
+
+        m_labels.resize(n);
+        m_owner.assign(n, 0);
+        m_move_log.resize(n);
+        m_log_position.assign(n, NOT_IN_LOG);
+        if( m_deterministic ) {
+                m_candidate_gain.assign(n, NO_CANDIDATE);
+                m_candidate_block.resize(n);
+        }
+
+        #pragma omp parallel for num_threads(m_num_threads) schedule(static)
+        for( NodeID node = 0; node < n; node++) {
+                m_labels[node] = G.getPartitionIndex(node);
+        }
+
+        EdgeWeight overall_improvement = 0;
+        bool sth_changed               = config.no_change_convergence;
+        int step_limit                 = config.kway_fm_step_limit; // same as in the sequential k-way search
+
+        for( unsigned i = 0; i < config.kway_rounds || sth_changed; i++) {
+                EdgeWeight improvement = parallel_kway_refinement_round(config, G, step_limit, i);
+
+                sth_changed = improvement != 0 && config.no_change_convergence;
+                if(improvement == 0) break; 
+                overall_improvement += improvement; 
+        } 
+
+        ASSERT_TRUE(overall_improvement >= 0);
+
+        #pragma omp parallel for num_threads(m_num_threads) schedule(static)
+        for( NodeID node = 0; node < n; node++) {
+                G.setPartitionIndex(node, m_labels[node]);
+        }
+
+        return overall_improvement;
+}
+
+EdgeWeight parallel_kway_graph_refinement::parallel_kway_refinement_round(PartitionConfig & config, 
+                                                                          graph_access & G, 
+                                                                          int step_limit, 
+                                                                          unsigned round) {
+        NodeID n = G.number_of_nodes();
+
+        std::vector<NodeID> start_nodes;
+        #pragma omp parallel num_threads(m_num_threads) 
+        {
+                std::vector<NodeID> local_start_nodes;
+                #pragma omp for schedule(dynamic, PARALLEL_FM_CHUNK_SIZE) nowait
+                for( NodeID node = 0; node < n; node++) {
+                        PartitionID block = m_labels[node];
+                        forall_out_edges(G, e, node) {
+                                if( m_labels[G.getEdgeTarget(e)] != block ) {
+                                        local_start_nodes.push_back(node);
+                                        break;
+                                }
+                        } endfor
+                }
+
+                #pragma omp critical
+                start_nodes.insert(start_nodes.end(), local_start_nodes.begin(), local_start_nodes.end());
+        }
+
+        if(start_nodes.size() == 0) return 0; // nothing to refine
+
+        // the order of the critical section above is arbitrary
+        std::sort(start_nodes.begin(), start_nodes.end());
+
+        std::vector<search_data> data(m_num_threads);
+        if( m_deterministic ) {
+                m_round_seed = (uint64_t)random_functions::nextInt(0, std::numeric_limits<int>::max()) * config.kway_rounds + round;
+                return deterministic_refinement_round(config, G, start_nodes, data);
+        }
+
+        random_functions::permutate_vector_fast(start_nodes, false);
+        for( int i = 0; i < m_num_threads; i++) {
+                data[i].gen.seed(random_functions::nextInt(0, std::numeric_limits<int>::max()) + round);
+        }
+
+        size_t batch_size   = std::max(1u, config.kway_fm_seeds_per_search);
+        size_t no_of_batches = (start_nodes.size() + batch_size - 1) / batch_size;
+        size_t next_batch    = 0;
+        m_log_size           = 0;
+
+        #pragma omp parallel num_threads(m_num_threads) 
+        {
+                search_data & local_data = data[omp_get_thread_num()];
+                while( true ) {
+                        size_t batch = __atomic_fetch_add(&next_batch, 1, __ATOMIC_RELAXED);
+                        if( batch >= no_of_batches ) break;
+
+                        size_t batch_begin = batch*batch_size;
+                        size_t batch_end   = std::min(batch_begin + batch_size, start_nodes.size());
+                        localized_search(config, G, start_nodes, batch_begin, batch_end, batch+1, step_limit, local_data);
+                }
+        }
+
+        EdgeWeight improvement = rollback_global_move_log(config, G);
+
+        if( config.statistics ) {
+                level_statistics & stats = config.statistics->current();
+                for( int i = 0; i < m_num_threads; i++) {
+                        stats.kway_moves     += data[i].performed_moves;
+                        stats.kway_rollbacks += data[i].rolled_back_moves;
+                }
+                stats.kway_rollbacks += m_global_rollbacks;
+        }
+
+        return improvement;
+}
+
+EdgeWeight parallel_kway_graph_refinement::deterministic_refinement_round(PartitionConfig & config, 
+                                                                          graph_access & G, 
+                                                                          const std::vector<NodeID> & boundary_nodes, 
+                                                                          std::vector<search_data> & data) {
+        const int sub_rounds = std::max(1, config.deterministic_sub_rounds);
+        m_log_size           = 0;
+
+        // the candidates of a sub-round are reset at its end, the arrays are NO_CANDIDATE between sub-rounds
+        std::vector<EdgeWeight> & candidate_gain   = m_candidate_gain;
+        std::vector<PartitionID> & candidate_block = m_candidate_block;
+        auto precedes = [&](NodeID lhs, NodeID rhs) {
+                return candidate_gain[lhs] > candidate_gain[rhs] || (candidate_gain[lhs] == candidate_gain[rhs] && lhs < rhs);
+        };
+
+        std::vector<NodeID> sub_round_nodes;
+        std::vector<unsigned char> selected;
+        for( int sub_round = 0; sub_round < sub_rounds; sub_round++) {
+                sub_round_nodes.clear();
+                for( size_t i = 0; i < boundary_nodes.size(); i++) {
+                        NodeID node = boundary_nodes[i];
+                        if( random_functions::counter_based(m_round_seed, node, 0) % sub_rounds == (uint64_t)sub_round ) {
+                                sub_round_nodes.push_back(node);
+                        }
+                }
+                const size_t no_of_nodes = sub_round_nodes.size();
+
+                #pragma omp parallel num_threads(m_num_threads) 
+                {
+                        search_data & local_data = data[omp_get_thread_num()];
+                        #pragma omp for schedule(dynamic, PARALLEL_FM_CHUNK_SIZE)
+                        for( size_t i = 0; i < no_of_nodes; i++) {
+                                NodeID node = sub_round_nodes[i];
+                                PartitionID to;
+                                Gain gain = compute_gain(G, node, to, local_data);
+                                if( to != INVALID_PARTITION && gain > 0 ) {
+                                        candidate_gain[node]  = gain;
+                                        candidate_block[node] = to;
+                                }
+                        }
+                }
+
+                // a candidate moves if it precedes all adjacent candidates, so the gains of the moves are exact
+                selected.assign(no_of_nodes, 0);
+                #pragma omp parallel for num_threads(m_num_threads) schedule(dynamic, PARALLEL_FM_CHUNK_SIZE)
+                for( size_t i = 0; i < no_of_nodes; i++) {
+                        NodeID node = sub_round_nodes[i];
+                        if( candidate_gain[node] == NO_CANDIDATE ) continue;
+
+                        bool move = true;
+                        forall_out_edges(G, e, node) {
+                                NodeID target = G.getEdgeTarget(e);
+                                if( candidate_gain[target] != NO_CANDIDATE && precedes(target, node) ) {
+                                        move = false;
+                                        break;
+                                }
+                        } endfor
+                        selected[i] = move;
+                }
+
+                // the log is written in node order, so it does not depend on the schedule
+                for( size_t i = 0; i < no_of_nodes; i++) {
+                        NodeID node = sub_round_nodes[i];
+                        if( selected[i] ) {
+                                fm_move & move = m_move_log[m_log_size++];
+                                move.node      = node;
+                                move.from      = m_labels[node];
+                                move.to        = candidate_block[node];
+                        }
+                        candidate_gain[node] = NO_CANDIDATE;
+                }
+
+                #pragma omp parallel for num_threads(m_num_threads) schedule(static)
+                for( size_t i = 0; i < no_of_nodes; i++) {
+                        if( selected[i] ) {
+                                NodeID node    = sub_round_nodes[i];
+                                m_labels[node] = candidate_block[node];
+                        }
+                }
+        }
+
+        // all logged gains are positive, the rollback only recomputes them and resets the log
+        EdgeWeight improvement = rollback_global_move_log(config, G);
+        if( config.statistics ) {
+                level_statistics & stats = config.statistics->current();
+                stats.kway_moves     += m_log_size;
+                stats.kway_rollbacks += m_global_rollbacks;
+        }
+        return improvement;
+}
+
+void parallel_kway_graph_refinement::localized_search(PartitionConfig & config, 
+                                                      graph_access & G, 
+                                                      const std::vector<NodeID> & start_nodes, 
+                                                      size_t batch_begin, 
+                                                      size_t batch_end,
+                                                      NodeID search_id, 
+                                                      int step_limit, 
+                                                      search_data & data) {
+        maxNodeHeap & queue = data.queue;
+
+        for( size_t i = batch_begin; i < batch_end; i++) {
+                NodeID node = start_nodes[i];
+                if( !claim(node, search_id) ) continue;
+
+                PartitionID max_gainer;
+                Gain gain = compute_gain(G, node, max_gainer, data);
+                if( max_gainer == INVALID_PARTITION ) {
+                        __atomic_store_n(&m_owner[node], 0, __ATOMIC_RELAXED);
+                        continue;
+                }
+                queue.insert(node, gain);
+                data.claimed.push_back(node);
+        }
+
+        if( queue.empty() ) {
+                data.claimed.clear();
+                return;
+        }
+
+        EdgeWeight cut      = 0;
+        EdgeWeight best_cut = 0;
+        int min_cut_index   = -1;
+        int number_of_swaps = 0;
+
+        kway_simple_stop_rule stopping_rule(config);
+        for( number_of_swaps = 0; !queue.empty(); number_of_swaps++) {
+                if( stopping_rule.search_should_stop(min_cut_index, number_of_swaps, step_limit) ) {
+                        break;
+                }
+
+                // keys in the queue are not updated when neighbors move (lazy evaluation), 
+                // so the gain is recomputed and the node is reinserted if it is not the best anymore
+                NodeID node = queue.deleteMax();
+                PartitionID to;
+                Gain gain = compute_gain(G, node, to, data);
+                if( to == INVALID_PARTITION ) {
+                        number_of_swaps--; // node is not a boundary node anymore
+                        continue;
+                }
+                if( !queue.empty() && gain < queue.maxValue() ) {
+                        queue.insert(node, gain);
+                        number_of_swaps--; 
+                        continue;
+                }
+
+                PartitionID from = m_labels[node];
+                __atomic_store_n(&m_labels[node], to, __ATOMIC_RELAXED);
+
+                cut -= gain;
+                if( cut <= best_cut ) {
+                        best_cut      = cut;
+                        min_cut_index = number_of_swaps;
+                }
+
+                fm_move move;
+                move.node = node;
+                move.from = from;
+                move.to   = to;
+                data.moves.push_back(move);
+
+                //expand the search to neighbors that are not claimed yet and whose gain can have increased 
+                forall_out_edges(G, e, node) {
+                        NodeID target     = G.getEdgeTarget(e);
+                        EdgeWeight weight = G.getEdgeWeight(e);
+                        PartitionID block = __atomic_load_n(&m_labels[target], __ATOMIC_RELAXED);
+                        if( (weight > 0 && block == to) || (weight < 0 && block == from) ) continue;
+
+                        NodeID owner = __atomic_load_n(&m_owner[target], __ATOMIC_RELAXED);
+                        if( owner == 0 && claim(target, search_id) ) {
+                                PartitionID targets_max_gainer;
+                                Gain target_gain = compute_gain(G, target, targets_max_gainer, data);
+                                if( targets_max_gainer != INVALID_PARTITION ) {
+                                        queue.insert(target, target_gain);
+                                        data.claimed.push_back(target);
+                                } else {
+                                        __atomic_store_n(&m_owner[target], 0, __ATOMIC_RELAXED);
+                                }
+                        }
+                } endfor
+        }
+
+        data.performed_moves   += data.moves.size();
+        data.rolled_back_moves += data.moves.size() - (min_cut_index + 1);
+
+        //roll backwards to the best prefix of this search
+        while( (int)data.moves.size() > min_cut_index + 1 ) {
+                fm_move & move = data.moves.back();
+                __atomic_store_n(&m_labels[move.node], move.from, __ATOMIC_RELAXED);
+                data.moves.pop_back();
+        }
+
+        // kept moves are locked for the rest of the round, all other claimed nodes are released
+        if( data.moves.size() > 0 ) {
+                size_t pos = __atomic_fetch_add(&m_log_size, data.moves.size(), __ATOMIC_RELAXED);
+                for( size_t i = 0; i < data.moves.size(); i++) {
+                        m_move_log[pos+i] = data.moves[i];
+                        __atomic_store_n(&m_owner[data.moves[i].node], LOCKED_NODE, __ATOMIC_RELAXED);
+                }
+        }
+
+        for( size_t i = 0; i < data.claimed.size(); i++) {
+                NodeID node = data.claimed[i];
+                if( m_owner[node] == search_id ) {
+                        __atomic_store_n(&m_owner[node], 0, __ATOMIC_RELAXED);
+                }
+        }
+
+        while( !queue.empty() ) queue.deleteMax();
+        data.moves.clear();
+        data.claimed.clear();
+}
+
+EdgeWeight parallel_kway_graph_refinement::rollback_global_move_log(PartitionConfig & config, graph_access & G) {
+        size_t log_size    = m_log_size;
+        m_global_rollbacks = 0;
+        if( log_size == 0 ) return 0;
+
+        #pragma omp parallel for num_threads(m_num_threads) schedule(static)
+        for( size_t i = 0; i < log_size; i++) {
+                m_log_position[m_move_log[i].node] = i;
+        }
+
+        // every node is at most once in the log. when move i is performed, neighbors that appear 
+        // earlier in the log are in their target block, all others are in the block they had before the round
+        std::vector<EdgeWeight> gains(log_size);
+        #pragma omp parallel for num_threads(m_num_threads) schedule(dynamic, PARALLEL_FM_CHUNK_SIZE)
+        for( size_t i = 0; i < log_size; i++) {
+                const fm_move & move = m_move_log[i];
+                EdgeWeight gain = 0;
+                forall_out_edges(G, e, move.node) {
+                        NodeID target = G.getEdgeTarget(e);
+                        EdgeID pos    = m_log_position[target];
+
+                        PartitionID target_block;
+                        if( pos == NOT_IN_LOG ) {
+                                target_block = m_labels[target];
+                        } else if( pos < i ) {
+                                target_block = m_move_log[pos].to;
+                        } else {
+                                target_block = m_move_log[pos].from;
+                        }
+
+                        if( target_block == move.to ) {
+                                gain += G.getEdgeWeight(e);
+                        } else if( target_block == move.from ) {
+                                gain -= G.getEdgeWeight(e);
+                        }
+                } endfor
+                gains[i] = gain;
+        }
+
+        EdgeWeight improvement      = 0;
+        EdgeWeight best_improvement = 0;
+        size_t best_prefix          = 0;
+        for( size_t i = 0; i < log_size; i++) {
+                improvement += gains[i];
+                if( improvement >= best_improvement ) {
+                        best_improvement = improvement;
+                        best_prefix      = i+1;
+                }
+        }
+
+        m_global_rollbacks = log_size - best_prefix;
+
+        #pragma omp parallel for num_threads(m_num_threads) schedule(static)
+        for( size_t i = 0; i < log_size; i++) {
+                const fm_move & move = m_move_log[i];
+                if( i >= best_prefix ) {
+                        m_labels[move.node] = move.from;
+                }
+                m_log_position[move.node] = NOT_IN_LOG;
+                m_owner[move.node]        = 0;
+        }
+
+        return best_improvement;
+}
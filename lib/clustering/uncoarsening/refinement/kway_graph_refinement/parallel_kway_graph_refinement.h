@@ -0,0 +1,154 @@
+/******************************************************************************
+ * parallel_kway_graph_refinement.h 
+ *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#ifndef PARALLEL_KWAY_GRAPH_REFINEMENT_T3NQ8W2C
+#define PARALLEL_KWAY_GRAPH_REFINEMENT_T3NQ8W2C
+
+#include <random>
+#include <vector>
+
+#include "data_structure/graph_access.h"
+#include "data_structure/priority_queues/maxNodeHeap.h"
+#include "data_structure/rating_map.h"
+#include "definitions.h"
+#include "partition_config.h"
+#include "random_functions.h"
+
+// localized k-way FM: many small FM searches run concurrently. every search is seeded by a disjoint 
+// batch of boundary nodes and may only move nodes that it claimed. moves are applied to the shared 
+// partition right away, each search rolls back to its own best prefix and appends the remaining moves 
+// to a global move log. afterwards the gains of the log are recomputed in log order and everything 
+// after the best prefix is rolled back, this undoes moves whose gains were spoiled by concurrent searches.
+//
+// with config.deterministic the result must not depend on the number of threads, so the searches are
+// replaced by synchronous sub-rounds: the boundary nodes are split into sub-rounds by a hash, in every
+// sub-round each node computes its best positive gain move on the labels of the previous sub-rounds and
+// a move is applied if no adjacent node of the same sub-round has a better (gain, node id) candidate.
+// ties between blocks are broken by counter based random numbers keyed by (seed, round, node, block).
+class parallel_kway_graph_refinement {
+        public:
+                parallel_kway_graph_refinement( );
+                virtual ~parallel_kway_graph_refinement();
+
+                EdgeWeight perform_refinement(PartitionConfig & config, 
+                                              graph_access & G);
+
+        private:
+                struct fm_move {
+                        NodeID node;
+                        PartitionID from;
+                        PartitionID to;
+                };
+
+                // thread owned data of the searches 
+                struct search_data {
+                        rating_map connectivity;
+                        maxNodeHeap queue;
+                        std::mt19937 gen;
+                        std::vector<fm_move> moves;
+                        std::vector<NodeID> claimed;
+                        EdgeID performed_moves   = 0;
+                        EdgeID rolled_back_moves = 0;
+                };
+
+                EdgeWeight parallel_kway_refinement_round(PartitionConfig & config, 
+                                                          graph_access & G, 
+                                                          int step_limit, 
+                                                          unsigned round);
+
+                EdgeWeight deterministic_refinement_round(PartitionConfig & config, 
+                                                          graph_access & G, 
+                                                          const std::vector<NodeID> & boundary_nodes, 
+                                                          std::vector<search_data> & data);
+
+                void localized_search(PartitionConfig & config, 
+                                      graph_access & G, 
+                                      const std::vector<NodeID> & start_nodes, 
+                                      size_t batch_begin, 
+                                      size_t batch_end,
+                                      NodeID search_id, 
+                                      int step_limit, 
+                                      search_data & data);
+
+                // rolls back the suffix of the global move log that does not improve the objective
+                EdgeWeight rollback_global_move_log(PartitionConfig & config, graph_access & G);
+
+                // same gain as kway_graph_refinement_commons::compute_gain, but computed on the shared 
+                // labels with a thread owned rating map and random generator (a hash in deterministic mode)
+                inline Gain compute_gain(graph_access & G, 
+                                         NodeID node, 
+                                         PartitionID & max_gainer, 
+                                         search_data & data);
+
+                inline bool claim(NodeID node, NodeID search_id);
+
+                std::vector<PartitionID> m_labels;
+                std::vector<NodeID>      m_owner;
+                std::vector<fm_move>     m_move_log;
+                std::vector<EdgeID>      m_log_position;
+                std::vector<EdgeWeight>  m_candidate_gain;  // deterministic mode, best move of a node in a sub-round
+                std::vector<PartitionID> m_candidate_block;
+                size_t                   m_log_size;
+                size_t                   m_global_rollbacks; // moves undone by the last global rollback
+                int                      m_num_threads;
+                bool                     m_deterministic;
+                uint64_t                 m_round_seed;
+};
+
+inline Gain parallel_kway_graph_refinement::compute_gain(graph_access & G, 
+                                                         NodeID node, 
+                                                         PartitionID & max_gainer, 
+                                                         search_data & data) {
+        PartitionID source_partition = __atomic_load_n(&m_labels[node], __ATOMIC_RELAXED);
+        EdgeWeight max_degree        = std::numeric_limits<EdgeWeight>::min();
+        EdgeWeight internal_degree   = 0;
+        uint64_t max_hash            = 0;
+        max_gainer                   = INVALID_PARTITION;
+
+        data.connectivity.prepare(G.getNodeDegree(node));
+        forall_out_edges(G, e, node) {
+                NodeID target = G.getEdgeTarget(e);
+                data.connectivity.add(__atomic_load_n(&m_labels[target], __ATOMIC_RELAXED), G.getEdgeWeight(e));
+        } endfor
+
+        for( size_t i = 0; i < data.connectivity.size(); i++) {
+                PartitionID target_partition = data.connectivity.key_at(i);
+                EdgeWeight local_degree      = data.connectivity.value_at(i);
+                if( target_partition == source_partition ) {
+                        internal_degree = local_degree;
+                        continue;
+                }
+
+                //break ties randomly
+                bool take = local_degree > max_degree;
+                if( local_degree == max_degree ) {
+                        take = m_deterministic 
+                               ? random_functions::counter_based(m_round_seed, node, target_partition) < max_hash 
+                               : (data.gen() & 1);
+                }
+
+                if( take ) {
+                        max_degree = local_degree;
+                        max_gainer = target_partition;
+                        if( m_deterministic ) max_hash = random_functions::counter_based(m_round_seed, node, max_gainer);
+                }
+        }
+        data.connectivity.clear();
+
+        if(max_gainer == INVALID_PARTITION) {
+                max_degree = 0;
+        }
+
+        return max_degree - internal_degree;
+}
+
+inline bool parallel_kway_graph_refinement::claim(NodeID node, NodeID search_id) {
+        NodeID expected = 0;
+        return __atomic_compare_exchange_n(&m_owner[node], &expected, search_id, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+#endif /* end of include guard: PARALLEL_KWAY_GRAPH_REFINEMENT_T3NQ8W2C */
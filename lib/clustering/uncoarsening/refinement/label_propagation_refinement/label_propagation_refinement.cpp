@@ -5,10 +5,20 @@
  * Christian Schulz <christian.schulz.phone@gmail.com>
  *****************************************************************************/
 
+#include <limits>
+#include <omp.h>
+#include <random>
+
 #include "label_propagation_refinement.h"
 #include "clustering/coarsening/clustering/node_ordering.h"
+#include "data_structure/clustering_workspace.h"
+#include "data_structure/compressed_graph.h"
+#include "data_structure/rating_map.h"
+#include "tools/clustering_statistics.h"
 #include "tools/random_functions.h"
 
+const NodeID PARALLEL_LP_REFINEMENT_CHUNK_SIZE = 1024;
+
 label_propagation_refinement::label_propagation_refinement() {
                 
 }
@@ -17,37 +27,63 @@ label_propagation_refinement::~label_propagation_refinement() {
                 
 }
 
-EdgeWeight label_propagation_refinement::perform_refinement(PartitionConfig & partition_config, graph_access & G) {
+template <typename Graph>
+EdgeWeight label_propagation_refinement::perform_refinement(PartitionConfig & partition_config, Graph & G) {
+        if(partition_config.parallel_lp_refinement) {
+                return parallel_perform_refinement(partition_config, G);
+        }
+
 	//random_functions::fastRandBool<uint64_t> random_obj;
         // coarse_mapping stores cluster id and the mapping (it is identical)
         //std::vector<NodeWeight> cluster_sizes(G.number_of_nodes(), 0);
-        std::vector<EdgeWeight> hash_map(G.number_of_nodes(), 0);
-        std::vector<NodeID> permutation(G.number_of_nodes());
+        clustering_workspace local_workspace;
+        clustering_workspace & workspace = partition_config.workspace ? *partition_config.workspace : local_workspace;
+
+        std::vector<EdgeWeight> & hash_map = workspace.hash_map;
+        std::vector<bool> & rated          = workspace.rated;
+        std::vector<NodeID> & permutation  = workspace.permutation;
+        hash_map.assign(G.number_of_nodes(), 0);
+        rated.assign(G.number_of_nodes(), false);
+        permutation.resize(G.number_of_nodes());
 
         node_ordering n_ordering;
         n_ordering.order_nodes(partition_config, G, permutation);
 
-        std::queue< NodeID > * Q             = new std::queue< NodeID >();
-        std::queue< NodeID > * next_Q        = new std::queue< NodeID >();
-        std::vector<bool> * Q_contained      = new std::vector<bool>(G.number_of_nodes(), false);
-        std::vector<bool> * next_Q_contained = new std::vector<bool> (G.number_of_nodes(), false);
+        std::vector< NodeID > * Q            = &workspace.queue;
+        std::vector< NodeID > * next_Q       = &workspace.next_queue;
+        std::vector<bool> * Q_contained      = &workspace.queue_contained;
+        std::vector<bool> * next_Q_contained = &workspace.next_queue_contained;
+        Q->clear();
+        next_Q->clear();
+        Q_contained->assign(G.number_of_nodes(), false);
+        next_Q_contained->assign(G.number_of_nodes(), false);
 
         forall_nodes(G, node) {
                 //cluster_sizes[G.getPartitionIndex(node)] += G.getNodeWeight(node);
-                Q->push(permutation[node]);
+                Q->push_back(permutation[node]);
         } endfor
 
         //std::cout <<  "partition " <<  partition_config.label_iterations_refinement  << std::endl;
+        unsigned iterations = 0;
+        NodeID total_moved  = 0;
         for( int j = 0; j < partition_config.label_iterations_refinement; j++) {
-                while( !Q->empty() ) {
-                        NodeID node = Q->front();
-                        Q->pop();
+                if( Q->empty() ) break;
+                iterations++;
+
+                for( size_t q = 0; q < Q->size(); q++) {
+                        NodeID node = (*Q)[q];
                         (*Q_contained)[node] = false;
 
                         //now move the node to the cluster that is most common in the neighborhood
-                        forall_out_edges(G, e, node) {
-                                NodeID target = G.getEdgeTarget(e);
-                                hash_map[G.getPartitionIndex(target)]+=G.getEdgeWeight(e);
+                        //(candidates are the clusters reached by a positive edge, see graph_access)
+                        forall_positive_neighbors(G, it, node) {
+                                NodeID target = it.target();
+                                hash_map[G.getPartitionIndex(target)]+=it.weight();
+                                rated[G.getPartitionIndex(target)] = true;
+                        } endfor
+                        forall_negative_neighbors(G, it, node) {
+                                NodeID target = it.target();
+                                if( rated[G.getPartitionIndex(target)] ) hash_map[G.getPartitionIndex(target)]+=it.weight();
                         } endfor
 
                         //second sweep for finding max and resetting array
@@ -57,8 +93,8 @@ EdgeWeight label_propagation_refinement::perform_refinement(PartitionConfig & pa
 
                         /* EdgeWeight max_value = hash_map[max_block]; */
                         EdgeWeight max_value = 0;
-                        forall_out_edges(G, e, node) {
-                                NodeID target             = G.getEdgeTarget(e);
+                        forall_positive_neighbors(G, it, node) {
+                                NodeID target             = it.target();
                                 PartitionID cur_block     = G.getPartitionIndex(target);
                                 EdgeWeight cur_value      = hash_map[cur_block];
                                 if(cur_value > max_value)
@@ -73,10 +109,11 @@ EdgeWeight label_propagation_refinement::perform_refinement(PartitionConfig & pa
                                 }
                         } endfor
 
-                        forall_out_edges(G, e, node) {
-                                NodeID target             = G.getEdgeTarget(e);
+                        forall_positive_neighbors(G, it, node) {
+                                NodeID target             = it.target();
                                 PartitionID cur_block     = G.getPartitionIndex(target);
                                 hash_map[cur_block] = 0;
+                                rated[cur_block]    = false;
                         } endfor
 
                         int pos = random_functions::nextInt(0, max_blocks.size()-1);
@@ -87,31 +124,189 @@ EdgeWeight label_propagation_refinement::perform_refinement(PartitionConfig & pa
                         G.setPartitionIndex(node, max_block);
 
                         if(changed_label) {
-                                forall_out_edges(G, e, node) {
-                                        NodeID target = G.getEdgeTarget(e);
+                                total_moved++;
+                                forall_neighbors(G, it, node) {
+                                        NodeID target = it.target();
                                         if(!(*next_Q_contained)[target]) {
-                                                next_Q->push(target);
+                                                next_Q->push_back(target);
                                                 (*next_Q_contained)[target] = true;
                                         } 
                                 } endfor
                         }
                 } 
 
+                Q->clear();
                 std::swap( Q, next_Q);
                 std::swap( Q_contained, next_Q_contained);
         }
 
         /* remap_cluster_ids(partition_config, G); */
+        if( partition_config.statistics ) {
+                partition_config.statistics->current().lp_refinement_iterations += iterations;
+                partition_config.statistics->current().lp_refinement_moves      += total_moved;
+        }
+
+        return 0;
+}
+
+template <typename Graph>
+EdgeWeight label_propagation_refinement::parallel_perform_refinement(PartitionConfig & partition_config, Graph & G) {
+        int num_threads = std::max(1, partition_config.n_threads);
+        NodeID n        = G.number_of_nodes();
 
-        delete Q;
-        delete next_Q;
-        delete Q_contained;
-        delete next_Q_contained;
+        clustering_workspace local_workspace;
+        clustering_workspace & workspace = partition_config.workspace ? *partition_config.workspace : local_workspace;
+
+        std::vector<NodeID> & permutation        = workspace.permutation;
+        std::vector<PartitionID> & labels        = workspace.block_id;
+        std::vector<unsigned char> & active      = workspace.active;
+        std::vector<unsigned char> & next_active = workspace.next_active;
+        std::vector<rating_map> & ratings        = workspace.ratings;
+        permutation.resize(n);
+        labels.resize(n);
+        active.assign(n, 1);
+        next_active.assign(n, 0);
+        if( ratings.size() < (size_t)num_threads ) ratings.resize(num_threads);
+
+        node_ordering n_ordering;
+        n_ordering.order_nodes(partition_config, G, permutation);
+
+        // in deterministic mode a single seed is drawn, so the global generator advances independently
+        // of the number of threads
+        bool deterministic = partition_config.deterministic;
+        bool hash_ties     = deterministic || partition_config.deterministic_tie_breaking;
+        std::vector<unsigned> seeds(deterministic ? 1 : num_threads);
+        for( size_t i = 0; i < seeds.size(); i++) {
+                seeds[i] = random_functions::nextInt(0, std::numeric_limits<int>::max());
+        }
+        uint64_t call_seed = deterministic ? seeds[0] : partition_config.seed;
+
+        // deterministic mode: the permutation is split into sub-rounds, the nodes of a sub-round
+        // choose their labels on the labels of the previous sub-rounds and are updated afterwards
+        int sub_rounds = deterministic ? std::max(1, partition_config.deterministic_sub_rounds) : 1;
+        std::vector<PartitionID> next_labels(deterministic ? n : 0);
+
+        PartitionID* labels_ptr        = &labels[0];
+        unsigned char* next_active_ptr = NULL;
+
+        #pragma omp parallel for num_threads(num_threads) schedule(static)
+        for( NodeID node = 0; node < n; node++) {
+                labels_ptr[node] = G.getPartitionIndex(node);
+                if( deterministic ) next_labels[node] = labels_ptr[node];
+        }
+
+        unsigned iterations = 0;
+        NodeID total_moved  = 0;
+        for( int j = 0; j < partition_config.label_iterations_refinement; j++) {
+                NodeID moved_nodes = 0;
+                next_active_ptr    = &next_active[0];
+                uint64_t round_seed = call_seed * partition_config.label_iterations_refinement + j;
+
+                for( int sub_round = 0; sub_round < sub_rounds; sub_round++) {
+                        NodeID begin = (uint64_t)n * sub_round / sub_rounds;
+                        NodeID end   = (uint64_t)n * (sub_round + 1) / sub_rounds;
+
+                        #pragma omp parallel num_threads(num_threads) reduction(+:moved_nodes)
+                        {
+                                int thread_id        = omp_get_thread_num();
+                                rating_map & rating  = ratings[thread_id];
+                                std::mt19937 gen(seeds[thread_id % seeds.size()] + j);
+                                std::uniform_int_distribution<int> coin(0,1);
+
+                                #pragma omp for schedule(dynamic, PARALLEL_LP_REFINEMENT_CHUNK_SIZE)
+                                for( NodeID i = begin; i < end; i++) {
+                                        NodeID node = permutation[i];
+                                        if( !active[node] ) continue;
+                                        active[node] = 0;
+
+                                        //now move the node to the cluster that is most common in the neighborhood
+                                        rating.prepare(G.getNodeDegree(node));
+                                        forall_positive_neighbors(G, it, node) {
+                                                NodeID target = it.target();
+                                                rating.add(__atomic_load_n(&labels_ptr[target], __ATOMIC_RELAXED), it.weight());
+                                        } endfor
+                                        forall_negative_neighbors(G, it, node) {
+                                                NodeID target = it.target();
+                                                rating.add_if_contained(__atomic_load_n(&labels_ptr[target], __ATOMIC_RELAXED), it.weight());
+                                        } endfor
+
+                                        // the own block competes with value zero if it is not adjacent
+                                        PartitionID own_block = labels_ptr[node];
+                                        PartitionID max_block = own_block;
+                                        EdgeWeight max_value  = 0;
+                                        uint64_t max_hash     = random_functions::counter_based(round_seed, node, own_block);
+                                        for( size_t r = 0; r < rating.size(); r++) {
+                                                EdgeWeight cur_value  = rating.value_at(r);
+                                                PartitionID cur_block = rating.key_at(r);
+                                                if( cur_value < max_value ) continue;
+
+                                                bool take = cur_value > max_value;
+                                                if( !take && hash_ties ) {
+                                                        uint64_t cur_hash = random_functions::counter_based(round_seed, node, cur_block);
+                                                        take = cur_hash < max_hash;
+                                                } else if( !take ) {
+                                                        take = coin(gen);
+                                                }
+
+                                                if( take ) {
+                                                        max_value = cur_value;
+                                                        max_block = cur_block;
+                                                        if( hash_ties ) {
+                                                                max_hash = random_functions::counter_based(round_seed, node, cur_block);
+                                                        }
+                                                }
+                                        }
+                                        rating.clear();
+
+                                        if( deterministic ) {
+                                                next_labels[node] = max_block;
+                                        } else if( max_block != own_block ) {
+                                                __atomic_store_n(&labels_ptr[node], max_block, __ATOMIC_RELAXED);
+                                                moved_nodes++;
+
+                                                forall_neighbors(G, it, node) {
+                                                        __atomic_store_n(&next_active_ptr[it.target()], 1, __ATOMIC_RELAXED);
+                                                } endfor
+                                        }
+                                }
+                        }
+
+                        if( !deterministic ) continue;
+
+                        #pragma omp parallel for num_threads(num_threads) schedule(dynamic, PARALLEL_LP_REFINEMENT_CHUNK_SIZE) reduction(+:moved_nodes)
+                        for( NodeID i = begin; i < end; i++) {
+                                NodeID node = permutation[i];
+                                if( next_labels[node] == labels_ptr[node] ) continue;
+
+                                labels_ptr[node] = next_labels[node];
+                                moved_nodes++;
+                                forall_neighbors(G, it, node) {
+                                        __atomic_store_n(&next_active_ptr[it.target()], 1, __ATOMIC_RELAXED);
+                                } endfor
+                        }
+                }
+
+                std::swap(active, next_active);
+                iterations++;
+                total_moved += moved_nodes;
+                if( moved_nodes == 0 ) break;
+        }
+
+        #pragma omp parallel for num_threads(num_threads) schedule(static)
+        for( NodeID node = 0; node < n; node++) {
+                G.setPartitionIndex(node, labels_ptr[node]);
+        }
+
+        if( partition_config.statistics ) {
+                partition_config.statistics->current().lp_refinement_iterations += iterations;
+                partition_config.statistics->current().lp_refinement_moves      += total_moved;
+        }
 
         return 0;
 }
 
-void label_propagation_refinement::remap_cluster_ids(PartitionConfig & partition_config, graph_access & G) {
+template <typename Graph>
+void label_propagation_refinement::remap_cluster_ids(PartitionConfig & partition_config, Graph & G) {
     PartitionID cur_no_clusters = 0;
     std::unordered_map<PartitionID, PartitionID> remap;
     forall_nodes(G, node) {
@@ -126,3 +321,8 @@ void label_propagation_refinement::remap_cluster_ids(PartitionConfig & partition
     G.set_partition_count(cur_no_clusters);
     partition_config.k = cur_no_clusters;
 }
+
+template EdgeWeight label_propagation_refinement::perform_refinement<graph_access>(PartitionConfig & partition_config, graph_access & G);
+template EdgeWeight label_propagation_refinement::perform_refinement<compressed_graph>(PartitionConfig & partition_config, compressed_graph & G);
+template void label_propagation_refinement::remap_cluster_ids<graph_access>(PartitionConfig & partition_config, graph_access & G);
+template void label_propagation_refinement::remap_cluster_ids<compressed_graph>(PartitionConfig & partition_config, compressed_graph & G);
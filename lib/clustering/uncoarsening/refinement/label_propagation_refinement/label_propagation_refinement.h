@@ -17,8 +17,17 @@ public:
         label_propagation_refinement();
         virtual ~label_propagation_refinement();
 
-        EdgeWeight perform_refinement(PartitionConfig & config, graph_access & G);
-        void remap_cluster_ids(PartitionConfig & partition_config, graph_access & G);
+        // Graph is graph_access or compressed_graph
+        template <typename Graph>
+        EdgeWeight perform_refinement(PartitionConfig & config, Graph & G);
+        template <typename Graph>
+        void remap_cluster_ids(PartitionConfig & partition_config, Graph & G);
+
+private:
+        // nodes are processed concurrently by partition_config.n_threads threads, 
+        // neighboring labels are read without synchronization (relaxed consistency)
+        template <typename Graph>
+        EdgeWeight parallel_perform_refinement(PartitionConfig & config, Graph & G);
 };
 
 
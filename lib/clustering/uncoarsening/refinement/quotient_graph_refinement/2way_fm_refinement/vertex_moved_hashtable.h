@@ -42,7 +42,7 @@ struct moved_index {
 
 class vertex_moved_hashtable {
         public:
-                vertex_moved_hashtable(int size ) {
+                vertex_moved_hashtable(int size = 0) {
                         elements.resize(size); 
                         for( unsigned i = 0; i < elements.size(); i++) {
                                 elements[i].index = NOT_QUEUED;
@@ -57,6 +57,12 @@ class vertex_moved_hashtable {
                         }
                 } ;
 
+                // reuses the memory if size is within the capacity
+                void resize(size_t size) {
+                        elements.resize(size);
+                        reset();
+                };
+
                 moved_index& operator[](int index) {
                         return elements[index];
                 };
@@ -6,13 +6,39 @@
  *****************************************************************************/
 
 //#include <clustering/uncoarsening/refinement/quotient_graph_refinement/quotient_graph_refinement.h>
+#include <clustering/uncoarsening/refinement/cluster_merge_refinement/cluster_merge_refinement.h>
 #include <clustering/uncoarsening/refinement/label_propagation_refinement/label_propagation_refinement.h>
 #include <clustering/uncoarsening/refinement/kway_graph_refinement/kway_graph_refinement.h>
 #include <clustering/uncoarsening/refinement/kway_graph_refinement/multitry_kway_fm.h>
+#include <clustering/uncoarsening/refinement/kway_graph_refinement/parallel_kway_graph_refinement.h>
+#include "data_structure/compressed_graph.h"
 #include "refinement.h"
 #include "timer.h"
+#include "tools/clustering_statistics.h"
 #include "tools/quality_metrics.h"
 
+static EdgeWeight current_edge_cut(PartitionConfig & config, graph_access & G) {
+        quality_metrics qm;
+        return qm.edge_cut(G);
+}
+
+static EdgeWeight current_edge_cut(PartitionConfig & config, compressed_graph & G) {
+        return G.edge_cut(config.n_threads);
+}
+
+static EdgeWeight perform_kway_refinement(PartitionConfig & config, graph_access & G, kway_graph_refinement & kway) {
+        if (config.parallel_kway_fm) {
+                parallel_kway_graph_refinement parallel_kway;
+                return parallel_kway.perform_refinement(config, G);
+        }
+        return kway.perform_refinement(config, G);
+}
+
+// the parallel k-way search logs moves by edge id, the compressed graph uses the sequential one
+static EdgeWeight perform_kway_refinement(PartitionConfig & config, compressed_graph & G, kway_graph_refinement & kway) {
+        return kway.perform_refinement(config, G);
+}
+
 refinement::refinement() {
                 
 }
@@ -21,7 +47,8 @@ refinement::~refinement() {
                 
 }
 
-EdgeWeight refinement::perform_refinement(PartitionConfig & config, graph_access * G) {
+template <typename Graph>
+EdgeWeight refinement::perform_refinement(PartitionConfig & config, Graph * G) {
     //quality_metrics qm;
     EdgeWeight overall_improvement = 0;
     //complete_boundary* boundary;
@@ -34,6 +61,10 @@ EdgeWeight refinement::perform_refinement(PartitionConfig & config, graph_access
 
     /* std::cout << "\nedge-cut   : " << qm.edge_cut(*G) << "\n"; */
 
+    if (config.statistics) {
+	    config.statistics->current().cut_before_refinement = current_edge_cut(config, *G);
+    }
+
     timer t;
     t.restart();
     // Label Propagation
@@ -58,8 +89,17 @@ EdgeWeight refinement::perform_refinement(PartitionConfig & config, graph_access
 	    /* std::cout << "edge-cut LP: " << qm.edge_cut(*G) << "\n"; */
     }
     //std::cout <<  "LP refinement " <<  t.elapsed()  << std::endl;
+    if (config.statistics) config.statistics->current().lp_refinement_time += t.elapsed();
     t.restart();
 
+    // Cluster Merging on the quotient graph
+    if (config.cluster_merge_refinement) {
+	    cluster_merge_refinement cluster_merge;
+	    overall_improvement += cluster_merge.perform_refinement(config, *G);
+	    if (config.statistics) config.statistics->current().cluster_merge_time += t.elapsed();
+	    t.restart();
+    }
+
     // Quotient Graph FM Local Search
     //if (!config.disable_quotient_refinement) {
 	    //int k = 0;
@@ -113,12 +153,13 @@ EdgeWeight refinement::perform_refinement(PartitionConfig & config, graph_access
 	    //boundary = new complete_boundary(G);
 	    //boundary->build(); // update boundary after remapping of cluster IDs as clusters may have disappeared
             //std::cout <<  "building boundary took " <<  t.elapsed() << std::endl;
-	    overall_improvement += kway->perform_refinement(config, *G);
+	    overall_improvement += perform_kway_refinement(config, *G, *kway);
 	    //delete boundary;
 
 	    /* std::cout << "edge-cut KW: " << qm.edge_cut(*G) << "\n"; */
     }
     //std::cout <<  "kFM refinement " <<  t.elapsed()  << std::endl;
+    if (config.statistics) config.statistics->current().kway_time += t.elapsed();
     //t.restart();
 
 
@@ -153,9 +194,16 @@ EdgeWeight refinement::perform_refinement(PartitionConfig & config, graph_access
 
 
 
+    if (config.statistics) {
+	    config.statistics->current().cut_after_refinement = current_edge_cut(config, *G);
+    }
+
     delete label_propagation;
     //delete fm_local_search;
     delete kway;
     //delete multitry_kway;
     return overall_improvement;
 }
+
+template EdgeWeight refinement::perform_refinement<graph_access>(PartitionConfig & config, graph_access * G);
+template EdgeWeight refinement::perform_refinement<compressed_graph>(PartitionConfig & config, compressed_graph * G);
@@ -16,7 +16,9 @@ class refinement {
 public:
         refinement( );
         virtual ~refinement();
-        EdgeWeight perform_refinement(PartitionConfig & config, graph_access * G);
+        // Graph is graph_access or compressed_graph
+        template <typename Graph>
+        EdgeWeight perform_refinement(PartitionConfig & config, Graph * G);
 };
 
 #endif /* end of include guard: REFINEMENT_UJN9IBHM */
@@ -5,8 +5,10 @@
  * Christian Schulz <christian.schulz.phone@gmail.com>
  *****************************************************************************/
 
+#include "data_structure/clustering_workspace.h"
 #include "graph_partition_assertions.h"
 #include "refinement/refinement.h"
+#include "tools/clustering_statistics.h"
 #include "uncoarsening.h"
 
 
@@ -18,17 +20,27 @@ uncoarsening::~uncoarsening() {
 
 }
 
-int uncoarsening::perform_uncoarsening(const PartitionConfig & partition_config, graph_hierarchy & hierarchy) {
+int uncoarsening::perform_uncoarsening(const PartitionConfig & partition_config, graph_hierarchy & hierarchy, unsigned first_level) {
         PartitionConfig copy_of_partition_config = partition_config;
         graph_access* coarsest  = hierarchy.get_coarsest();
         refinement* refine      = new refinement();
         graph_access* to_delete = NULL;
 
+        // level of the graph that is refined next, the coarsest graph is the last one in the hierarchy
+        unsigned level = first_level + hierarchy.size() - 1;
+        if(partition_config.statistics) {
+                partition_config.statistics->select_level(level, coarsest->number_of_nodes(), coarsest->number_of_edges());
+        }
+
         int improvement = 0;
         improvement += (int) refine->perform_refinement(copy_of_partition_config, coarsest);
 
         while(!hierarchy.isEmpty()) {
                 graph_access* G = hierarchy.pop_finer_and_project();
+                level--;
+                if(partition_config.statistics) {
+                        partition_config.statistics->select_level(level, G->number_of_nodes(), G->number_of_edges());
+                }
 
                 //call refinement
                 improvement += (int) refine->perform_refinement(copy_of_partition_config, G);
@@ -36,7 +48,7 @@ int uncoarsening::perform_uncoarsening(const PartitionConfig & partition_config,
 
                 //clean up
                 if(to_delete != NULL) {
-                    delete to_delete;
+                    release_graph(partition_config, to_delete);
 		    to_delete = NULL;
                 }
                 if(!hierarchy.isEmpty()) {
@@ -45,6 +57,14 @@ int uncoarsening::perform_uncoarsening(const PartitionConfig & partition_config,
         }
 
 	delete refine;
-	delete coarsest;
+	release_graph(partition_config, coarsest);
         return improvement;
 }
+
+void uncoarsening::release_graph(const PartitionConfig & partition_config, graph_access * G) {
+        if(partition_config.workspace) {
+                partition_config.workspace->release_graph(G);
+        } else {
+                delete G;
+        }
+}
@@ -16,7 +16,12 @@ public:
         uncoarsening( );
         virtual ~uncoarsening();
         
-        int perform_uncoarsening(const PartitionConfig & partition_config, graph_hierarchy & hierarchy);
+        // first_level is the level of the finest graph of the hierarchy in the statistics
+        int perform_uncoarsening(const PartitionConfig & partition_config, graph_hierarchy & hierarchy, unsigned first_level = 0);
+
+private:
+        // hands a coarse graph back to the workspace of the run, deletes it if there is none
+        void release_graph(const PartitionConfig & partition_config, graph_access * G);
 };
 
 
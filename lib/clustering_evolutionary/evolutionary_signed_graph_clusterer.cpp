@@ -5,12 +5,14 @@
 #include <algorithm>
 #include <iostream>
 #include <mpi.h>
+#include <omp.h>
 #include "diversifyer.h"
 #include "exchange/exchanger.h"
 #include "graph_partitioner.h"
 #include "evolutionary_signed_graph_clusterer.h"
 #include "quality_metrics.h"
 #include "random_functions.h"
+#include "tools/mpi_tools.h"
 
 evolutionary_signed_graph_clusterer::evolutionary_signed_graph_clusterer() : MASTER(0), m_time_limit(0) {
 	m_best_global_objective = std::numeric_limits<EdgeWeight>::max();
@@ -51,6 +53,16 @@ void evolutionary_signed_graph_clusterer::perform_evolutionary_signed_clustering
 	//m_t.restart();
 	initialize( ini_working_config, G);
 
+	// the edges of G are split by sign (if used) during the first clustering, before they are shared
+	if( partition_config.sign_split_adjacency && !G.has_sign_split_edges() ) {
+		G.split_edges_by_sign(partition_config.n_threads);
+	}
+	for( int i = 1; i < partition_config.n_threads; i++) {
+		graph_access * worker_G = new graph_access();
+		worker_G->share_topology(G);
+		m_worker_graphs.push_back(worker_G);
+	}
+
 	exchanger ex(m_communicator);
 	do {
 		PartitionConfig working_config  = partition_config;
@@ -93,41 +105,22 @@ void evolutionary_signed_graph_clusterer::perform_evolutionary_signed_clustering
 		m_island->write_log(filename);
 	}
 
+	for( size_t i = 0; i < m_worker_graphs.size(); i++) {
+		delete m_worker_graphs[i];
+	}
+	m_worker_graphs.clear();
 	delete m_island;
 }
 
 void evolutionary_signed_graph_clusterer::initialize(PartitionConfig & working_config, graph_access & G) {
-        quality_metrics qm;
 	if(working_config.input_partition  != "") {
 		Individuum ind = {NULL, 0, NULL};
-		ind.objective     = qm.objective(working_config, G, working_config.input_assignments);
-		ind.partition_map = working_config.input_assignments;
-		ind.cut_edges     = new std::vector<EdgeID>();
-
-		forall_nodes(G, node) {
-			forall_out_edges(G, e, node) {
-				NodeID target = G.getEdgeTarget(e);
-				if(ind.partition_map[node] != ind.partition_map[target]) {
-					ind.cut_edges->push_back(e);
-				}
-			} endfor
-		} endfor
+		population::encode_individuum(working_config, G, working_config.input_assignments, ind);
 		m_island->insert(G, ind);
 	}
 	if(working_config.input_partition2 != "") {
 		Individuum ind = {NULL, 0, NULL};
-		ind.objective     = qm.objective(working_config, G, working_config.input_assignments2);
-		ind.partition_map = working_config.input_assignments2;
-		ind.cut_edges     = new std::vector<EdgeID>();
-
-		forall_nodes(G, node) {
-			forall_out_edges(G, e, node) {
-				NodeID target = G.getEdgeTarget(e);
-				if(ind.partition_map[node] != ind.partition_map[target]) {
-					ind.cut_edges->push_back(e);
-				}
-			} endfor
-		} endfor
+		population::encode_individuum(working_config, G, working_config.input_assignments2, ind);
 		m_island->insert(G, ind);
 	}
 
@@ -145,6 +138,10 @@ void evolutionary_signed_graph_clusterer::initialize(PartitionConfig & working_c
         std::cout << "Improved local objective: " << first_one.objective << " Elapsed time: " << m_t.elapsed() << " Rank: " << m_rank << std::endl;
         m_best_local_objective = first_one.objective;
 	double time_spend = m_t.elapsed();
+
+	// compact storage vs. an int per node and the directed cut edge ids
+	size_t individuum_bytes = population::memory_in_bytes(first_one);
+	size_t plain_bytes      = G.number_of_nodes()*sizeof(int) + 2*first_one.cut_edges->size()*sizeof(EdgeID);
 	m_island->insert(G, first_one);
 
 	//compute S and Bcast
@@ -174,6 +171,7 @@ void evolutionary_signed_graph_clusterer::initialize(PartitionConfig & working_c
 		population_size = std::min(100, population_size);
 	}
 	std::cout <<  "poolsize = " <<  population_size  << std::endl;
+	std::cout <<  "memory per individuum = " <<  individuum_bytes <<  " bytes (plain " <<  plain_bytes <<  " bytes)" << std::endl;
 
 	//set S
 	m_island->set_pool_size(population_size);
@@ -186,9 +184,9 @@ EdgeWeight evolutionary_signed_graph_clusterer::collect_best_clustering(graph_ac
 	EdgeWeight min_objective = 0;
 	m_island->apply_fittest(G, min_objective);
 
-	int best_local_objective  = min_objective;
-	int best_local_objective_m  = min_objective;
-	int best_global_objective = 0;
+	EdgeWeight best_local_objective  = min_objective;
+	EdgeWeight best_local_objective_m  = min_objective;
+	EdgeWeight best_global_objective = 0;
 
 	PartitionID* best_local_map = new PartitionID[G.number_of_nodes()];
 	std::vector< NodeWeight > block_sizes(G.get_partition_count(),0);
@@ -205,18 +203,18 @@ EdgeWeight evolutionary_signed_graph_clusterer::collect_best_clustering(graph_ac
 		}
 	}
 
-	MPI_Allreduce(&best_local_objective_m, &best_global_objective, 1, MPI_INT, MPI_MIN, m_communicator);
+	MPI_Allreduce(&best_local_objective_m, &best_global_objective, 1, MPI_EDGEWEIGHT, MPI_MIN, m_communicator);
 
-	if( best_global_objective == std::numeric_limits< int >::max()) {
+	if( best_global_objective == std::numeric_limits< EdgeWeight >::max()) {
 		//no partition is feasible
-		MPI_Allreduce(&best_local_objective, &best_global_objective, 1, MPI_INT, MPI_MIN, m_communicator);
+		MPI_Allreduce(&best_local_objective, &best_global_objective, 1, MPI_EDGEWEIGHT, MPI_MIN, m_communicator);
 	}
 
-	int my_domain_weight   = best_local_objective == best_global_objective ?
-		max_domain_weight : std::numeric_limits<int>::max();
-	int best_domain_weight = max_domain_weight;
+	NodeWeight my_domain_weight   = best_local_objective == best_global_objective ?
+		max_domain_weight : std::numeric_limits<NodeWeight>::max();
+	NodeWeight best_domain_weight = max_domain_weight;
 
-	MPI_Allreduce(&my_domain_weight, &best_domain_weight, 1, MPI_INT, MPI_MIN, m_communicator);
+	MPI_Allreduce(&my_domain_weight, &best_domain_weight, 1, MPI_NODEWEIGHT, MPI_MIN, m_communicator);
 
 	// now we know what the best objective is ... find the best balance
 	int bcaster = best_local_objective == best_global_objective
@@ -224,7 +222,7 @@ EdgeWeight evolutionary_signed_graph_clusterer::collect_best_clustering(graph_ac
 	int g_bcaster = 0;
 
 	MPI_Allreduce(&bcaster, &g_bcaster, 1, MPI_INT, MPI_MIN, m_communicator);
-	MPI_Bcast(best_local_map, G.number_of_nodes(), MPI_INT, g_bcaster, m_communicator);
+	MPI_Bcast(best_local_map, G.number_of_nodes(), MPI_PARTITIONID, g_bcaster, m_communicator);
 
 	forall_nodes(G, node) {
 		G.setPartitionIndex(node, best_local_map[node]);
@@ -237,7 +235,6 @@ EdgeWeight evolutionary_signed_graph_clusterer::collect_best_clustering(graph_ac
 
 EdgeWeight evolutionary_signed_graph_clusterer::perform_local_clustering(PartitionConfig & working_config, graph_access & G) {
 
-	quality_metrics qm;
 	unsigned local_repetitions = working_config.local_partitioning_repetitions;
 
 	if( working_config.mh_diversify ) {
@@ -245,76 +242,56 @@ EdgeWeight evolutionary_signed_graph_clusterer::perform_local_clustering(Partiti
 		div.diversify(working_config);
 	}
 
-	//start a new round
-	for( unsigned i = 0; i < local_repetitions; i++) {
-	//if( working_config.mh_diversify ) {
-		diversifyer div;
-		div.diversify(working_config);
-	
-		if( working_config.mh_no_mh ) {
-			Individuum first_ind = {NULL, 0, NULL};
+	// worker 0 is the master thread and continues its random sequence, the other workers are
+	// reseeded every round since their thread local generators may not survive the parallel region
+	const int num_workers = m_worker_graphs.size() + 1;
+	std::vector<int> seeds(num_workers, 0);
+	for( int i = 1; i < num_workers; i++) {
+		seeds[i] = random_functions::nextInt(0, std::numeric_limits<int>::max());
+	}
 
-                        //working_config.global_cycle_iterations=5;
-			m_island->createIndividuum(working_config, G, first_ind);
-			m_island->insert(G, first_ind);
-		} else {
-			if( m_island->is_full() && !working_config.mh_disable_combine) {
+	std::vector< std::pair<EdgeWeight, double> > improvements;
+	bool time_over = false;
 
-				int decision = random_functions::nextInt(0,9);
-				Individuum output = {NULL, 0, NULL};
+	//start a new round
+	#pragma omp parallel num_threads(num_workers)
+	{
+		int worker = omp_get_thread_num();
+		graph_access & worker_G = worker == 0 ? G : *m_worker_graphs[worker-1];
+
+		PartitionConfig worker_config = working_config;
+		worker_config.n_threads       = 1;
+		if( worker > 0 ) {
+			random_functions::setSeed(seeds[worker]);
+			worker_config.statistics = NULL;
+		}
 
-				if(decision < working_config.mh_flip_coin) {
-					m_island->mutate_random(working_config, G, output);
-					m_island->insert(G, output);
+		#pragma omp for schedule(dynamic, 1)
+		for( unsigned i = 0; i < local_repetitions; i++) {
+			if( __atomic_load_n(&time_over, __ATOMIC_RELAXED) ) continue;
 
-                                        //Individuum first_rnd = {NULL, 0, NULL};
-					//Individuum output2 = {NULL, 0, NULL};
+			perform_local_step(worker_config, worker_G);
 
-                                        ////std::cout <<  "calling new mutate"  << std::endl;
-                                        //m_island->get_one_individual_tournament(first_rnd);
-                                        //m_island->mutate_random(working_config, G, first_rnd, output2);
-                                        //m_island->insert(G, output2);
-				} else {
-					int combine_decision = random_functions::nextInt(0,9);
-					Individuum first_rnd = {NULL, 0, NULL};
-					Individuum second_rnd = {NULL, 0, NULL};
-					if(working_config.mh_enable_tournament_selection) {
-						m_island->get_two_individuals_tournament(first_rnd, second_rnd);
-					} else {
-						m_island->get_two_random_individuals(first_rnd, second_rnd);
-					}
-
-                                        if(combine_decision == 0) {
-						m_island->combine(working_config, G, first_rnd, second_rnd, output);
-                                        } else {
-                                                m_island->combine_ensemble(working_config, G, first_rnd, second_rnd, output);
-                                        }
-					m_island->insert(G, output);
-				}
-			} else {
-				Individuum first_ind = {NULL, 0, NULL};
-				if(m_island->is_full()) {
-					m_island->mutate_random(working_config, G, first_ind);
-				} else {
-					m_island->createIndividuum(working_config, G, first_ind);
+			Individuum best_ind = {NULL, 0, NULL};
+			m_island->get_best_individuum(best_ind);
+
+			#pragma omp critical
+			{
+				if( best_ind.objective < m_best_local_objective) {
+					m_best_local_objective = best_ind.objective;
+					improvements.push_back(std::make_pair(m_best_local_objective, m_t.elapsed()));
 				}
-				m_island->insert(G, first_ind);
 			}
-		}
 
-                Individuum best_ind = {NULL, 0, NULL};
-                m_island->get_best_individuum(best_ind);
-
-                if( best_ind.objective < m_best_local_objective) {
-                        m_best_local_objective = best_ind.objective;
-                        std::cout << "Improved local objective: " << m_best_local_objective << " Elapsed time: " << m_t.elapsed() << " Rank: " << m_rank << std::endl;
-                }
-
-		//try to combine to random individuals from pool
-		if( m_t.elapsed() > m_time_limit ) {
-			break;
+			//try to combine to random individuals from pool
+			if( m_t.elapsed() > m_time_limit ) {
+				__atomic_store_n(&time_over, true, __ATOMIC_RELAXED);
+			}
 		}
+	}
 
+	for( size_t i = 0; i < improvements.size(); i++) {
+		std::cout << "Improved local objective: " << improvements[i].first << " Elapsed time: " << improvements[i].second << " Rank: " << m_rank << std::endl;
 	}
 
 	EdgeWeight min_objective = 0;
@@ -322,3 +299,52 @@ EdgeWeight evolutionary_signed_graph_clusterer::perform_local_clustering(Partiti
 
 	return min_objective;
 }
+
+void evolutionary_signed_graph_clusterer::perform_local_step(PartitionConfig & working_config, graph_access & G) {
+	//if( working_config.mh_diversify ) {
+	diversifyer div;
+	div.diversify(working_config);
+
+	if( working_config.mh_no_mh ) {
+		Individuum first_ind = {NULL, 0, NULL};
+
+		//working_config.global_cycle_iterations=5;
+		m_island->createIndividuum(working_config, G, first_ind);
+		m_island->insert(G, first_ind);
+	} else {
+		if( m_island->is_full() && !working_config.mh_disable_combine) {
+
+			int decision = random_functions::nextInt(0,9);
+			Individuum output = {NULL, 0, NULL};
+
+			if(decision < working_config.mh_flip_coin) {
+				m_island->mutate_random(working_config, G, output);
+				m_island->insert(G, output);
+			} else {
+				int combine_decision = random_functions::nextInt(0,9);
+				Individuum first_rnd = {NULL, 0, NULL};
+				Individuum second_rnd = {NULL, 0, NULL};
+				// copies, concurrent workers may evict the parents from the population
+				m_island->get_two_individuals_copy(working_config.mh_enable_tournament_selection,
+				                                   first_rnd, second_rnd);
+
+				if(combine_decision == 0) {
+					m_island->combine(working_config, G, first_rnd, second_rnd, output);
+				} else {
+					m_island->combine_ensemble(working_config, G, first_rnd, second_rnd, output);
+				}
+				population::delete_individuum(first_rnd);
+				population::delete_individuum(second_rnd);
+				m_island->insert(G, output);
+			}
+		} else {
+			Individuum first_ind = {NULL, 0, NULL};
+			if(m_island->is_full()) {
+				m_island->mutate_random(working_config, G, first_ind);
+			} else {
+				m_island->createIndividuum(working_config, G, first_ind);
+			}
+			m_island->insert(G, first_ind);
+		}
+	}
+}
@@ -7,11 +7,16 @@
 
 
 #include <mpi.h>
+#include <vector>
 #include "data_structure/graph_access.h"
 #include "partition_config.h"
 #include "population.h"
 #include "timer.h"
 
+// one island of the memetic algorithm per MPI rank. the local repetitions of a round are distributed
+// over config.n_threads worker threads that share the population and the graph of the rank, every
+// worker clusters on its own partition arrays (see graph_access::share_topology) and runs the
+// clusterer sequentially. only the master thread communicates.
 class evolutionary_signed_graph_clusterer {
     public:
         evolutionary_signed_graph_clusterer();
@@ -25,6 +30,9 @@ class evolutionary_signed_graph_clusterer {
         void perform_cycle_clustering(PartitionConfig & graph_partitioner_config, graph_access & G);
 
     private:
+        // one recombination, mutation or new individual of a worker, inserted into the population
+        void perform_local_step(PartitionConfig & working_config, graph_access & G);
+
         //misc
         const unsigned MASTER;
         timer    m_t;
@@ -42,6 +50,8 @@ class evolutionary_signed_graph_clusterer {
 
         //island
         population* m_island;
+        // graphs of the worker threads 1..n_threads-1, worker 0 uses the input graph
+        std::vector<graph_access*> m_worker_graphs;
         MPI_Comm m_communicator;
 };
 
@@ -5,9 +5,9 @@
  * Christian Schulz <christian.schulz.phone@gmail.com>
  *****************************************************************************/
 
+#include <cstring>
 #include <mpi.h>
 #include "exchanger.h"
-#include "tools/quality_metrics.h"
 #include "tools/random_functions.h"
 
 exchanger::exchanger(MPI_Comm communicator) {
@@ -44,13 +44,12 @@ exchanger::~exchanger() {
         
         while(flag) {
                 int message_length;
-                MPI_Get_count(&st, MPI_INT, &message_length);
+                MPI_Get_count(&st, MPI_BYTE, &message_length);
                  
-                int* partition_map = new int[message_length];
+                std::vector<uint8_t> message(message_length);
                 MPI_Status rst;
-                MPI_Recv( partition_map, message_length, MPI_INT, st.MPI_SOURCE, rank, m_communicator, &rst); 
-                
-                delete[] partition_map;
+                MPI_Recv( message.data(), message_length, MPI_BYTE, st.MPI_SOURCE, rank, m_communicator, &rst); 
+
                 MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, m_communicator, &flag, &st);
         }
 
@@ -62,8 +61,8 @@ exchanger::~exchanger() {
         for( unsigned i = 0; i < m_request_pointers.size(); i++) {
                 MPI_Status st;
                 MPI_Wait( m_request_pointers[i], & st );
-                delete[] m_partition_map_buffers[i];
-                delete   m_request_pointers[i];
+                delete m_message_buffers[i];
+                delete m_request_pointers[i];
         }
                 
 }
@@ -138,31 +137,49 @@ void exchanger::quick_start( PartitionConfig & config, graph_access & G, populat
 }
 
 
+// An individuum is sent as its objective, its packed cluster ids (see packed_partition) and its
+// encoded cut edges (see cut_edge_list). The receiver takes all of them as is, it neither evaluates
+// the objective again nor scans the edges of the graph.
+void exchanger::write_message(const Individuum & ind, std::vector<uint8_t> & buffer) {
+        int64_t objective = ind.objective;
+        buffer.resize(sizeof(objective));
+        memcpy(&buffer[0], &objective, sizeof(objective));
+        ind.partition_map->write(buffer);
+        ind.cut_edges->write(buffer);
+}
+
+void exchanger::read_message(const PartitionConfig & config, const std::vector<uint8_t> & buffer, Individuum & ind) {
+        int64_t objective;
+        memcpy(&objective, &buffer[0], sizeof(objective));
+
+        ind.objective     = (EdgeWeight)objective;
+        ind.partition_map = new packed_partition();
+        ind.cut_edges     = new cut_edge_list();
+
+        const uint8_t * position = ind.partition_map->read(&buffer[0] + sizeof(objective));
+        ind.cut_edges->read(position, config.mh_diversity_sketch_size);
+}
+
 void exchanger::exchange_individum( const PartitionConfig & config,  graph_access & G, 
                                     int & from, int & rank, int & to, 
                                     Individuum & in, Individuum & out) {
         //recv. edge cut, partition_map, cut_edges from "from"
         //send in to "to"
 
-        int* partition_map = new int[G.number_of_nodes()];
-        out.partition_map  = partition_map;
-        out.cut_edges      = new std::vector<EdgeID>();
+        std::vector<uint8_t> send_message;
+        write_message(in, send_message);
 
         MPI_Status st;
-        MPI_Sendrecv( in.partition_map , G.number_of_nodes(), MPI_INT, to, 0, 
-                      out.partition_map, G.number_of_nodes(), MPI_INT, from, 0, m_communicator, &st); 
-
-        //recompute cut edges and edge cut locally
-        forall_nodes(G, node) {
-                forall_out_edges(G, e, node) {
-                        NodeID target = G.getEdgeTarget(e);
-                        if(partition_map[node] != partition_map[target]) {
-                                out.cut_edges->push_back(e);
-                        }
-                } endfor
-        } endfor
+        int send_length = send_message.size();
+        int recv_length = 0;
+        MPI_Sendrecv( &send_length, 1, MPI_INT, to, 0, 
+                      &recv_length, 1, MPI_INT, from, 0, m_communicator, &st); 
 
-        out.objective = m_qm.objective(config, G, partition_map);
+        std::vector<uint8_t> recv_message(recv_length);
+        MPI_Sendrecv( send_message.data(), send_length, MPI_BYTE, to, 0, 
+                      recv_message.data(), recv_length, MPI_BYTE, from, 0, m_communicator, &st); 
+
+        read_message(config, recv_message, out);
 }
 
 
@@ -202,10 +219,8 @@ void exchanger::push_best( PartitionConfig & config, graph_access & G, populatio
         }
 
         if(something_todo) {
-                int* partition_map = new int[G.number_of_nodes()];
-                forall_nodes(G, node) {
-                        partition_map[node] = G.getPartitionIndex(node);
-                } endfor
+                std::vector<uint8_t>* message = new std::vector<uint8_t>();
+                write_message(best_ind, *message);
 
                 int target = rank;
                 while( m_allready_send_to[target] ) {
@@ -215,12 +230,12 @@ void exchanger::push_best( PartitionConfig & config, graph_access & G, populatio
                 }
 
                 MPI_Request* rq = new MPI_Request;
-                MPI_Isend( partition_map, G.number_of_nodes(), MPI_INT, target, target, m_communicator, rq);
+                MPI_Isend( message->data(), message->size(), MPI_BYTE, target, target, m_communicator, rq);
                 
                 m_cur_num_pushes++;
 
                 m_request_pointers.push_back( rq );
-                m_partition_map_buffers.push_back( partition_map );
+                m_message_buffers.push_back( message );
 
                 m_allready_send_to[target] = true;
         }
@@ -232,12 +247,12 @@ void exchanger::push_best( PartitionConfig & config, graph_access & G, populatio
 
                 if(finished) {
                         std::swap(m_request_pointers[i], m_request_pointers[m_request_pointers.size()-1]);
-                        std::swap(m_partition_map_buffers[i], m_partition_map_buffers[m_request_pointers.size()-1]);
+                        std::swap(m_message_buffers[i], m_message_buffers[m_request_pointers.size()-1]);
 
-                        delete[] m_partition_map_buffers[m_partition_map_buffers.size() - 1];
-                        delete   m_request_pointers[m_request_pointers.size() - 1];
+                        delete m_message_buffers[m_message_buffers.size() - 1];
+                        delete m_request_pointers[m_request_pointers.size() - 1];
 
-                        m_partition_map_buffers.pop_back();
+                        m_message_buffers.pop_back();
                         m_request_pointers.pop_back();
                 }
         }
@@ -252,27 +267,17 @@ void exchanger::recv_incoming( PartitionConfig & config, graph_access & G, popul
         
         while(flag) {
                 Individuum out = {NULL, 0, NULL};
-                int* partition_map = new int[G.number_of_nodes()];
-                out.partition_map  = partition_map;
-                out.cut_edges      = new std::vector<EdgeID>();
+                int message_length;
+                MPI_Get_count(&st, MPI_BYTE, &message_length);
 
+                std::vector<uint8_t> message(message_length);
                 MPI_Status rst;
-                MPI_Recv( out.partition_map, G.number_of_nodes(), MPI_INT, st.MPI_SOURCE, rank, m_communicator, &rst); 
+                MPI_Recv( message.data(), message_length, MPI_BYTE, st.MPI_SOURCE, rank, m_communicator, &rst); 
                 
-                //recompute cut edges and edge cut locally
-                forall_nodes(G, node) {
-                        forall_out_edges(G, e, node) {
-                                NodeID target = G.getEdgeTarget(e);
-                                if(partition_map[node] != partition_map[target]) {
-                                        out.cut_edges->push_back(e);
-                                }
-                        } endfor
-                } endfor
-
-                out.objective = m_qm.objective(config, G, partition_map);
+                read_message(config, message, out);
                 island.insert( G, out );
 
-                if( (unsigned)out.objective < (unsigned)m_prev_best_objective) {
+                if( out.objective < m_prev_best_objective) {
                         m_prev_best_objective = out.objective;
                         /* std::cout << "rank " <<  rank */ 
                         /*           <<   ": pool improved (inc) **************************************** " */ 
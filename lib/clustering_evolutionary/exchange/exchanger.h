@@ -8,11 +8,12 @@
 #ifndef EXCHANGER_YPB6QKNL
 #define EXCHANGER_YPB6QKNL
 
+#include <cstdint>
 #include <mpi.h>
+#include <vector>
 #include "data_structure/graph_access.h"
 #include "clustering_evolutionary/population.h"
 #include "partition_config.h"
-#include "tools/quality_metrics.h"
 
 class exchanger {
 public:
@@ -32,17 +33,19 @@ private:
                                 int & to, 
                                 Individuum & in, Individuum & out);
 
-        std::vector< int* >          m_partition_map_buffers;
+        // wire format of an individuum (see exchanger.cpp)
+        static void write_message(const Individuum & ind, std::vector<uint8_t> & buffer);
+        static void read_message(const PartitionConfig & config, const std::vector<uint8_t> & buffer, Individuum & ind);
+
+        std::vector< std::vector<uint8_t>* > m_message_buffers;
         std::vector< MPI_Request* >  m_request_pointers;
         std::vector<bool>            m_allready_send_to;
 
-        int m_prev_best_objective;
+        EdgeWeight m_prev_best_objective;
         int m_max_num_pushes;
         int m_cur_num_pushes;
 
         MPI_Comm m_communicator;
-
-        quality_metrics m_qm;
 };
 
 
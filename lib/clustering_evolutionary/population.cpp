@@ -21,6 +21,7 @@
 
 population::population( MPI_Comm communicator, const PartitionConfig & partition_config ) {
         m_population_size    = partition_config.mh_pool_size;
+        m_diversity_verify   = partition_config.mh_diversity_verify;
         m_time_stamp         = 0;
         m_communicator       = communicator;
         m_global_timer.restart();
@@ -28,8 +29,7 @@ population::population( MPI_Comm communicator, const PartitionConfig & partition
 
 population::~population() {
         for( unsigned i = 0; i < m_internal_population.size(); i++) {
-                delete[] (m_internal_population[i].partition_map);
-                delete m_internal_population[i].cut_edges;
+                delete_individuum(m_internal_population[i]);
         }
 }
 
@@ -43,11 +43,7 @@ void population::createIndividuum(const PartitionConfig & config, graph_access &
         signed_graph_clusterer clusterer;
         quality_metrics qm;
 
-        std::ofstream ofs;
-        std::streambuf* backup = std::cout.rdbuf();
-        ofs.open("/dev/null");
-        std::cout.rdbuf(ofs.rdbuf()); 
-
+        // the clusterer does not write to std::cout, so the worker threads leave it alone
         timer t; t.restart();
 
         // diversify parameters
@@ -55,33 +51,20 @@ void population::createIndividuum(const PartitionConfig & config, graph_access &
         clusterer.perform_signed_clustering(copy, G);
 	copy.k = G.number_of_nodes();
 	G.set_partition_count(copy.k);
-        ofs.close();
-        std::cout.rdbuf(backup);
-
-        int* partition_map = new int[G.number_of_nodes()];
 
+        std::vector<int> partition_map(G.number_of_nodes());
         forall_nodes(G, node) {
                 partition_map[node] = G.getPartitionIndex(node);
         } endfor
+        encode_individuum(config, G, &partition_map[0], ind);
 
-        ind.objective     = qm.objective(config, G, partition_map);
-        ind.partition_map = partition_map;
-        ind.cut_edges     = new std::vector<EdgeID>();
-
-        forall_nodes(G, node) {
-                forall_out_edges(G, e, node) {
-                        NodeID target = G.getEdgeTarget(e);
-                        if(partition_map[node] != partition_map[target]) {
-                                ind.cut_edges->push_back(e);
-                        }
-                } endfor
-        } endfor
-
+        std::lock_guard<std::mutex> lock(m_mutex);
         m_filebuffer_string <<  m_global_timer.elapsed() <<  " " <<  ind.objective <<  std::endl;
         m_time_stamp++;
 }
 
 void population::insert(graph_access & G, Individuum & ind) {
+        std::lock_guard<std::mutex> lock(m_mutex);
         if(m_internal_population.size() < m_population_size) {
                 m_internal_population.push_back(ind);
         } else {
@@ -92,56 +75,61 @@ void population::insert(graph_access & G, Individuum & ind) {
                         }
                 }         
                 if(ind.objective > worst_objective ) {
-                        delete[] (ind.partition_map);
-                        delete ind.cut_edges;
+                        delete_individuum(ind);
                         return; // do nothing
                 }
                 //else measure similarity
+                std::vector<unsigned> candidates;
+                for( unsigned i = 0; i < m_internal_population.size(); i++) {
+                        if(m_internal_population[i].objective >= ind.objective) {
+                                candidates.push_back(i);
+                        }
+                }
+
+                // with sketches, the similarities are estimated and only the candidates that may be the
+                // most similar one within two standard errors are measured exactly if requested
+                if( !ind.cut_edges->sketch().empty() ) {
+                        std::vector<const cut_edge_sketch*> sketches(candidates.size());
+                        for( unsigned c = 0; c < candidates.size(); c++) {
+                                sketches[c] = &m_internal_population[candidates[c]].cut_edges->sketch();
+                        }
+
+                        std::vector<unsigned> selected;
+                        cut_edge_sketch::select_most_similar(sketches, ind.cut_edges->sketch(), m_diversity_verify, selected);
+                        for( unsigned s = 0; s < selected.size(); s++) {
+                                selected[s] = candidates[selected[s]];
+                        }
+                        candidates.swap(selected);
+                }
+
                 unsigned max_similarity = std::numeric_limits<unsigned>::max();
                 unsigned max_similarity_idx = 0;
-                for( unsigned i = 0; i < m_internal_population.size(); i++) {
+                for( unsigned c = 0; c < candidates.size(); c++) {
                         // Get individual with the must similar cut edges
-                        if(m_internal_population[i].objective >= ind.objective) {
-                                //now measure
-				int diff_size = m_internal_population[i].cut_edges->size() + ind.cut_edges->size();
-				std::vector<EdgeID> output_diff(diff_size,std::numeric_limits<EdgeID>::max());
-
-                                set_symmetric_difference(m_internal_population[i].cut_edges->begin(),
-                                                         m_internal_population[i].cut_edges->end(),
-                                                         ind.cut_edges->begin(),
-                                                         ind.cut_edges->end(),
-                                                         output_diff.begin());
-
-                                unsigned similarity = 0;
-                                for( unsigned j = 0; j < output_diff.size(); j++) {
-                                        if(output_diff[j] < std::numeric_limits<EdgeID>::max()) {
-                                                similarity++;
-                                        } else {
-                                                break;
-                                        }
-                                }
-
-                                if( similarity < max_similarity) {
-                                        max_similarity     = similarity;
-                                        max_similarity_idx = i;
-                                }
+                        unsigned i = candidates[c];
+                        unsigned similarity = candidates.size() == 1 ? 0 :
+                                              cut_edge_list::symmetric_difference_size(*m_internal_population[i].cut_edges,
+                                                                                       *ind.cut_edges);
+
+                        if( similarity < max_similarity) {
+                                max_similarity     = similarity;
+                                max_similarity_idx = i;
                         }
                 }         
 
-                delete[] (m_internal_population[max_similarity_idx].partition_map);
-                delete m_internal_population[max_similarity_idx].cut_edges;
+                delete_individuum(m_internal_population[max_similarity_idx]);
 
                 m_internal_population[max_similarity_idx] = ind;
         }
 }
 
 void population::replace(Individuum & in, Individuum & out) {
+        std::lock_guard<std::mutex> lock(m_mutex);
         //first find it:
         for( unsigned i = 0; i < m_internal_population.size(); i++) {
                 if(m_internal_population[i].partition_map == in.partition_map) {
                         //found it
-                        delete[] (m_internal_population[i].partition_map);
-                        delete m_internal_population[i].cut_edges;
+                        delete_individuum(m_internal_population[i]);
 
                         m_internal_population[i] = out;
                         break;
@@ -159,13 +147,13 @@ void population::combine(const PartitionConfig & partition_config,
         G.resizeSecondPartitionIndex(G.number_of_nodes());
         if( first_ind.objective < second_ind.objective ) {
                 forall_nodes(G, node) {
-                        G.setPartitionIndex(node, first_ind.partition_map[node]);
-                        G.setSecondPartitionIndex(node, second_ind.partition_map[node]);
+                        G.setPartitionIndex(node, (*first_ind.partition_map)[node]);
+                        G.setSecondPartitionIndex(node, (*second_ind.partition_map)[node]);
                 } endfor
         } else {
                 forall_nodes(G, node) {
-                        G.setPartitionIndex(node, second_ind.partition_map[node]);
-                        G.setSecondPartitionIndex(node, first_ind.partition_map[node]);
+                        G.setPartitionIndex(node, (*second_ind.partition_map)[node]);
+                        G.setSecondPartitionIndex(node, (*first_ind.partition_map)[node]);
                 } endfor
         }
 
@@ -192,8 +180,8 @@ void population::combine_ensemble(const PartitionConfig & partition_config,
 
         forall_nodes(G, node) {
                 ensemble_pair cur_pair;
-                cur_pair.lhs = first_ind.partition_map[node];
-                cur_pair.rhs = second_ind.partition_map[node];
+                cur_pair.lhs = (*first_ind.partition_map)[node];
+                cur_pair.rhs = (*second_ind.partition_map)[node];
                 cur_pair.n   = G.number_of_nodes();
 
                 if(new_mapping.find(cur_pair) == new_mapping.end()) {
@@ -287,21 +275,15 @@ void population::mutate_random( const PartitionConfig & partition_config, graph_
         config.combine					= false;
         config.graph_already_partitioned		= true;
         config.block_cut_edges_only_in_first_level	= true;
-        get_random_individuum(first_ind);
+        get_random_individuum_copy(first_ind);
 
-        if(number < 5) {
-                forall_nodes(G, node) {
-                        G.setPartitionIndex(node, first_ind.partition_map[node]);
-                } endfor
-                createIndividuum( config, G, first_ind);
+        first_ind.partition_map->unpack(G);
+        delete_individuum(first_ind);
 
-        } else {
-                forall_nodes(G, node) {
-                        G.setPartitionIndex(node, first_ind.partition_map[node]);
-                } endfor
+        if(number >= 5) {
                 config.graph_already_partitioned  = false;
-                createIndividuum( config, G, first_ind);
         }
+        createIndividuum( config, G, first_ind);
 }
 
 void population::get_two_random_individuals(Individuum & first, Individuum & second) {
@@ -341,7 +323,63 @@ void population::get_random_individuum(Individuum & ind) {
         ind     = m_internal_population[idx];
 }
 
+void population::get_two_individuals_copy(bool tournament, Individuum & first, Individuum & second) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Individuum first_rnd, second_rnd;
+        if( tournament ) {
+                get_two_individuals_tournament(first_rnd, second_rnd);
+        } else {
+                get_two_random_individuals(first_rnd, second_rnd);
+        }
+        copy_individuum(first_rnd, first);
+        copy_individuum(second_rnd, second);
+}
+
+void population::get_random_individuum_copy(Individuum & ind) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Individuum rnd;
+        get_random_individuum(rnd);
+        copy_individuum(rnd, ind);
+}
+
+void population::encode_individuum(const PartitionConfig & config, graph_access & G, int * partition_map, Individuum & ind) {
+        quality_metrics qm;
+        ind.objective     = qm.objective(config, G, partition_map);
+        ind.partition_map = new packed_partition();
+        ind.cut_edges     = new cut_edge_list();
+        ind.partition_map->pack(partition_map, G.number_of_nodes());
+        ind.cut_edges->build(G, partition_map, config.mh_diversity_sketch_size);
+}
+
+void population::copy_individuum(const Individuum & in, Individuum & out) {
+        out.objective     = in.objective;
+        out.partition_map = new packed_partition(*in.partition_map);
+        out.cut_edges     = new cut_edge_list(*in.cut_edges);
+}
+
+size_t population::memory_in_bytes(const Individuum & ind) {
+        return sizeof(Individuum) + sizeof(packed_partition) + ind.partition_map->memory_in_bytes()
+               + sizeof(cut_edge_list) + ind.cut_edges->memory_in_bytes();
+}
+
+size_t population::memory_in_bytes() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t bytes = 0;
+        for( unsigned i = 0; i < m_internal_population.size(); i++) {
+                bytes += memory_in_bytes(m_internal_population[i]);
+        }
+        return bytes;
+}
+
+void population::delete_individuum(Individuum & ind) {
+        delete ind.partition_map;
+        delete ind.cut_edges;
+        ind.partition_map = NULL;
+        ind.cut_edges     = NULL;
+}
+
 void population::get_best_individuum(Individuum & ind) {
+        std::lock_guard<std::mutex> lock(m_mutex);
         EdgeWeight min_objective = std::numeric_limits<EdgeWeight>::max();
         unsigned idx = 0;
 
@@ -356,19 +394,19 @@ void population::get_best_individuum(Individuum & ind) {
 }
 
 bool population::is_full() {
+        std::lock_guard<std::mutex> lock(m_mutex);
         return m_internal_population.size() == m_population_size;
 }
 
 void population::apply_fittest( graph_access & G, EdgeWeight & objective ) {
+        std::lock_guard<std::mutex> lock(m_mutex);
         EdgeWeight min_objective = std::numeric_limits<EdgeWeight>::max();
 	double best_balance      = std::numeric_limits<EdgeWeight>::max();
         unsigned idx             = 0;
 
 	    quality_metrics qm;
         for( unsigned i = 0; i < m_internal_population.size(); i++) {
-		        forall_nodes(G, node) {
-			            G.setPartitionIndex(node, m_internal_population[i].partition_map[node]);
-		        } endfor
+		        m_internal_population[i].partition_map->unpack(G);
 		        double cur_balance = qm.balance(G);
 
                 if((EdgeWeight) m_internal_population[i].objective < min_objective ||
@@ -379,9 +417,7 @@ void population::apply_fittest( graph_access & G, EdgeWeight & objective ) {
                 }
         }
 
-        forall_nodes(G, node) {
-                G.setPartitionIndex(node, m_internal_population[idx].partition_map[node]);
-        } endfor
+        m_internal_population[idx].partition_map->unpack(G);
 
         objective = min_objective;
 }
@@ -413,11 +449,9 @@ void population::mutate( const PartitionConfig & partition_config, graph_access
         mutate_random_incclusters(partition_config, G, second_ind, output_b);
         //combine_improved_multilevel(partition_config, G, output_a, output_b, output_ind);
 
-        delete[] (output_a.partition_map);
-        delete output_a.cut_edges;
+        delete_individuum(output_a);
 
-        delete[] (output_b.partition_map);
-        delete output_b.cut_edges;
+        delete_individuum(output_b);
 }
 
 void population::mutate_random_incclusters( const PartitionConfig & partition_config, graph_access & G, Individuum & first_ind, Individuum & output_ind) {
@@ -426,7 +460,7 @@ void population::mutate_random_incclusters( const PartitionConfig & partition_co
         std::vector< unsigned > clustering(G.number_of_nodes(), 0);
         std::mt19937 gen{ std::random_device{}() };
         forall_nodes(G, node) {
-                clustering[node] = first_ind.partition_map[node];
+                clustering[node] = (*first_ind.partition_map)[node];
                 G.setPartitionIndex(node, clustering[node]);
         } endfor
 
@@ -467,7 +501,7 @@ void population::mutate_random_incclusters( const PartitionConfig & partition_co
         std::uniform_real_distribution<double> dist_eps{ 0.1, 0.5 };
         for(unsigned cluster: selected_clusters) {
                 graph_access E;
-                std::vector<unsigned> mapping;
+                std::vector<NodeID> mapping;
                 graph_extractor{ }.extract_block(G, E, cluster, mapping);
 
                 PartitionConfig working_config;
@@ -507,27 +541,12 @@ void population::mutate_random_incclusters( const PartitionConfig & partition_co
         } endfor
         std::cout <<  "k_new " << k      << std::endl;}
         
-        int* partition_map = new int[G.number_of_nodes()];
-        forall_nodes(G, node) {
-                partition_map[node] = clustering[node];
-        } endfor
+        std::vector<int> partition_map(clustering.begin(), clustering.end());
 
         //G.set_partition_count(G.get_partition_count_compute());
-        quality_metrics qm;
-        output_ind.objective = qm.objective(partition_config, G, partition_map);
-        output_ind.partition_map    = partition_map;
-        output_ind.cut_edges        = new std::vector<EdgeID>();
+        encode_individuum(partition_config, G, &partition_map[0], output_ind);
         std::cout <<  "output has " <<  output_ind.objective  << std::endl;
 
-        forall_nodes(G, node) {
-                forall_out_edges(G, e, node) {
-                        NodeID target = G.getEdgeTarget(e);
-                        if(partition_map[node] != partition_map[target]) {
-                                output_ind.cut_edges->push_back(e);
-                        }
-                } endfor
-        } endfor
-
         //std::cout <<  "leaving"  << std::endl;
 
 }
@@ -6,19 +6,26 @@
 #ifndef POPULATION_AEFH46G6
 #define POPULATION_AEFH46G6
 
+#include <mutex>
 #include <sstream>
 #include <mpi.h>
 
+#include "data_structure/cut_edge_list.h"
 #include "data_structure/graph_access.h"
+#include "data_structure/packed_partition.h"
 #include "partition_config.h"
 #include "timer.h"
 
+// cluster ids are bit packed, every undirected cut edge is stored once (see encode_individuum)
 struct Individuum {
-        int* partition_map;
+        packed_partition* partition_map;
         EdgeWeight objective;
-        std::vector<EdgeID>* cut_edges; //sorted
+        cut_edge_list* cut_edges; //sorted
 };
 
+// the population can be shared by the worker threads of a rank. insert, replace and the queries of
+// the best individuals are thread safe. the selections return individuals that stay owned by the
+// population and may be evicted by a concurrent insert, worker threads use the *_copy variants
 struct ENC {
         std::vector<NodeID> vertices;
 };
@@ -68,6 +75,17 @@ class population {
 
                 void get_random_individuum(Individuum & ind);
 
+                // thread safe selections, the copies are owned by the caller (see delete_individuum)
+                void get_two_individuals_copy(bool tournament, Individuum & first, Individuum & second);
+                void get_random_individuum_copy(Individuum & ind);
+
+                // the individuum of the clustering partition_map of G (cluster ids >= 0)
+                static void encode_individuum(const PartitionConfig & config, graph_access & G,
+                                              int * partition_map, Individuum & ind);
+                static void copy_individuum(const Individuum & in, Individuum & out);
+                static void delete_individuum(Individuum & ind);
+                static size_t memory_in_bytes(const Individuum & ind);
+
                 void get_best_individuum(Individuum & ind);
 
                 bool is_full(); 
@@ -75,6 +93,9 @@ class population {
                 void apply_fittest( graph_access & G, EdgeWeight & objective);
 
                 unsigned size() { return m_internal_population.size(); }
+
+                // memory of all individuals
+                size_t memory_in_bytes();
                 
                 void print();
 
@@ -84,12 +105,15 @@ class population {
         private:
                 int m_time_stamp;
                 unsigned m_population_size;
+                bool m_diversity_verify;
                 std::vector<Individuum> m_internal_population;
 
                 MPI_Comm m_communicator;
 
                 std::stringstream m_filebuffer_string;
                 timer m_global_timer;
+
+                std::mutex m_mutex;
 };
 
 
@@ -0,0 +1,72 @@
+/******************************************************************************
+ * clustering_workspace.cpp
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#include <sys/mman.h>
+
+#include "clustering_workspace.h"
+
+const size_t HUGE_PAGE_SIZE = 2*1024*1024;
+
+clustering_workspace::~clustering_workspace() {
+        for( size_t i = 0; i < m_graph_pool.size(); i++) {
+                delete m_graph_pool[i];
+        }
+}
+
+template <typename T>
+void clustering_workspace::reserve_buffer(std::vector<T> & buffer, size_t size, bool huge_pages) {
+        buffer.reserve(size);
+        if( !huge_pages ) return;
+
+        // the memory is not touched yet, so the advice applies to the first page faults.
+        // only the 2MB aligned part of the buffer can be backed by huge pages
+        size_t begin = ((size_t)buffer.data() + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+        size_t end   = ((size_t)buffer.data() + buffer.capacity()*sizeof(T)) & ~(HUGE_PAGE_SIZE - 1);
+#ifdef MADV_HUGEPAGE
+        if( begin < end ) madvise((void*)begin, end - begin, MADV_HUGEPAGE);
+#endif
+}
+
+void clustering_workspace::reserve(NodeID n, EdgeID m, int num_threads, bool huge_pages) {
+        reserve_buffer(hash_map,    n, huge_pages);
+        reserve_buffer(permutation, n, huge_pages);
+        reserve_buffer(cluster_id,  n, huge_pages);
+        reserve_buffer(block_id,    n, huge_pages);
+        reserve_buffer(queue,       n, huge_pages);
+        reserve_buffer(next_queue,  n, huge_pages);
+        reserve_buffer(active,      n, huge_pages);
+        reserve_buffer(next_active, n, huge_pages);
+        reserve_buffer(nodes_by_cluster, n, huge_pages);
+        rated.reserve(n);
+        queue_contained.reserve(n);
+        next_queue_contained.reserve(n);
+
+        ratings.resize(num_threads);
+        edge_buffer.resize(num_threads);
+        for( int i = 0; i < num_threads; i++) {
+                reserve_buffer(edge_buffer[i], m / num_threads, huge_pages);
+        }
+
+        moved_idx.resize(n);
+}
+
+graph_access * clustering_workspace::acquire_graph() {
+        if( m_graph_pool.empty() ) return new graph_access();
+
+        graph_access * G = m_graph_pool.back();
+        m_graph_pool.pop_back();
+        return G;
+}
+
+void clustering_workspace::release_graph(graph_access * G) {
+        // keep the pool sorted by capacity, the largest graph is handed out first
+        std::vector<graph_access*>::iterator pos = m_graph_pool.begin();
+        while( pos != m_graph_pool.end() && (*pos)->edge_capacity() <= G->edge_capacity() ) {
+                ++pos;
+        }
+        m_graph_pool.insert(pos, G);
+}
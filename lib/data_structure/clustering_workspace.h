@@ -0,0 +1,67 @@
+/******************************************************************************
+ * clustering_workspace.h
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#ifndef CLUSTERING_WORKSPACE_W4N8QF1C
+#define CLUSTERING_WORKSPACE_W4N8QF1C
+
+#include <vector>
+
+#include "clustering/uncoarsening/refinement/quotient_graph_refinement/2way_fm_refinement/vertex_moved_hashtable.h"
+#include "data_structure/graph_access.h"
+#include "data_structure/rating_map.h"
+#include "definitions.h"
+
+// Scratch memory of one clustering run (all levels of all global cycles). The buffers are sized
+// once for the finest graph, the algorithms of a level only resize/assign them to the size of their
+// graph, which stays within the capacity and therefore neither allocates nor touches new pages.
+// The algorithms use PartitionConfig::workspace if it is set and a local instance otherwise.
+class clustering_workspace {
+        public:
+                clustering_workspace() {};
+                virtual ~clustering_workspace();
+
+                clustering_workspace(const clustering_workspace&) = delete;
+
+                // capacity for graphs with up to n nodes and m edges, optionally backed by transparent huge pages
+                void reserve(NodeID n, EdgeID m, int num_threads, bool huge_pages);
+
+                // coarse graphs are recycled: the graphs released during uncoarsening are handed out again
+                // in the next global cycle, largest capacity first. The levels acquire their graphs from
+                // the finest to the coarsest, so every level gets back a graph of (about) its size and the
+                // capacities do not grow from cycle to cycle, whatever order the graphs are released in.
+                graph_access * acquire_graph();
+                void release_graph(graph_access * G);
+
+                // label propagation (coarsening and refinement)
+                std::vector<EdgeWeight>    hash_map;    // all zero between two nodes
+                std::vector<bool>          rated;       // all false between two nodes
+                std::vector<NodeID>        permutation;
+                std::vector<NodeID>        cluster_id;
+                std::vector<PartitionID>   block_id;
+                std::vector<NodeID>        queue;
+                std::vector<NodeID>        next_queue;
+                std::vector<bool>          queue_contained;
+                std::vector<bool>          next_queue_contained;
+                std::vector<unsigned char> active;
+                std::vector<unsigned char> next_active;
+                std::vector<rating_map>    ratings;     // one per thread
+
+                // contraction
+                std::vector<NodeID>                nodes_by_cluster;
+                std::vector< std::vector< Edge > > edge_buffer; // one per thread
+
+                // k-way local search
+                vertex_moved_hashtable     moved_idx;
+
+        private:
+                template <typename T>
+                static void reserve_buffer(std::vector<T> & buffer, size_t size, bool huge_pages);
+
+                std::vector<graph_access*> m_graph_pool;
+};
+
+#endif /* end of include guard: CLUSTERING_WORKSPACE_W4N8QF1C */
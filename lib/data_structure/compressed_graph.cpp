@@ -0,0 +1,96 @@
+/******************************************************************************
+ * compressed_graph.cpp
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#include <algorithm>
+#include <omp.h>
+
+#include "compressed_graph.h"
+
+const NodeID COMPRESSION_CHUNK_SIZE = 1024;
+
+compressed_graph::compressed_graph() : m_number_of_nodes(0), m_number_of_edges(0), m_sign_split(false),
+                                       m_unit_weights(true), m_partition_count(0) {
+}
+
+size_t compressed_graph::encode_node(NodeID node, const Edge * begin, const Edge * end, uint8_t * out) const {
+        const Edge * split = begin;
+        while( split != end && split->weight > 0 ) split++;
+
+        // the header is followed by the encoding of the positive group, whose size is part of the header
+        size_t positive_bytes = 0;
+        for( const Edge * edge = begin; edge != split; edge++) {
+                uint64_t gap = edge == begin ? zigzag_encode((int64_t)edge->target - (int64_t)node) : edge->target - (edge-1)->target;
+                positive_bytes += encode_varint(gap, NULL);
+                if( !m_unit_weights ) positive_bytes += encode_varint(edge->weight, NULL);
+        }
+
+        size_t bytes = 0;
+        bytes += encode_varint(split - begin, out ? out + bytes : NULL);
+        bytes += encode_varint(end - split, out ? out + bytes : NULL);
+        bytes += encode_varint(positive_bytes, out ? out + bytes : NULL);
+
+        for( const Edge * edge = begin; edge != end; edge++) {
+                bool first_of_group = edge == begin || edge == split;
+                uint64_t gap = first_of_group ? zigzag_encode((int64_t)edge->target - (int64_t)node) : edge->target - (edge-1)->target;
+                bytes += encode_varint(gap, out ? out + bytes : NULL);
+                if( !m_unit_weights ) {
+                        uint64_t magnitude = edge->weight > 0 ? edge->weight : -edge->weight;
+                        bytes += encode_varint(magnitude, out ? out + bytes : NULL);
+                }
+        }
+        return bytes;
+}
+
+void compressed_graph::build(graph_access & G, bool sign_split, int num_threads) {
+        const NodeID n    = G.number_of_nodes();
+        bool unit_weights = true;
+
+        #pragma omp parallel for num_threads(std::max(1, num_threads)) reduction(&&:unit_weights)
+        for( NodeID node = 0; node < n; node++) {
+                forall_out_edges(G, e, node) {
+                        unit_weights = unit_weights && (G.getEdgeWeight(e) == 1 || G.getEdgeWeight(e) == -1);
+                } endfor
+        }
+
+        auto source = [&](NodeID node, std::vector<Edge> & edges) {
+                forall_neighbors(G, it, node) {
+                        Edge edge;
+                        edge.target = it.target();
+                        edge.weight = it.weight();
+                        edges.push_back(edge);
+                } endfor
+                return G.getNodeWeight(node);
+        };
+        build(n, G.number_of_edges(), sign_split, unit_weights, num_threads, source);
+
+        forall_nodes(G, node) {
+                m_partition_index[node] = G.getPartitionIndex(node);
+        } endfor
+        m_partition_count = G.get_partition_count();
+}
+
+EdgeWeight compressed_graph::edge_cut(int num_threads) {
+        const NodeID n = m_number_of_nodes;
+        EdgeWeight cut = 0;
+
+        #pragma omp parallel for num_threads(std::max(1, num_threads)) schedule(dynamic, COMPRESSION_CHUNK_SIZE) reduction(+:cut)
+        for( NodeID node = 0; node < n; node++) {
+                PartitionID block = m_partition_index[node];
+                forall_neighbors((*this), it, node) {
+                        if( m_partition_index[it.target()] != block ) cut += it.weight();
+                } endfor
+        }
+        return cut/2;
+}
+
+size_t compressed_graph::memory_in_bytes() const {
+        return m_offsets.capacity()*sizeof(size_t)
+               + m_data.capacity()
+               + m_node_weights.capacity()*sizeof(NodeWeight)
+               + m_partition_index.capacity()*sizeof(PartitionID)
+               + m_second_partition_index.capacity()*sizeof(PartitionID);
+}
@@ -0,0 +1,279 @@
+/******************************************************************************
+ * compressed_graph.h
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#ifndef COMPRESSED_GRAPH_T6JD2LQ8
+#define COMPRESSED_GRAPH_T6JD2LQ8
+
+#include <algorithm>
+#include <omp.h>
+#include <stdint.h>
+#include <vector>
+
+#include "data_structure/graph_access.h"
+#include "definitions.h"
+
+// Varint (LEB128) helpers of the compressed adjacency.
+inline size_t encode_varint(uint64_t value, uint8_t * out) {
+        size_t bytes = 0;
+        while( value >= 0x80 ) {
+                if( out ) out[bytes] = (uint8_t)(value | 0x80);
+                value >>= 7;
+                bytes++;
+        }
+        if( out ) out[bytes] = (uint8_t)value;
+        return bytes + 1;
+}
+
+inline uint64_t decode_varint(const uint8_t * & in) {
+        uint64_t value = *in & 0x7F;
+        unsigned shift = 7;
+        while( *in++ & 0x80 ) {
+                value |= (uint64_t)(*in & 0x7F) << shift;
+                shift += 7;
+        }
+        return value;
+}
+
+inline uint64_t zigzag_encode(int64_t value) { return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63); }
+inline int64_t zigzag_decode(uint64_t value) { return (int64_t)(value >> 1) ^ -(int64_t)(value & 1); }
+
+// Decodes the neighborhood of a node of a compressed_graph, same interface as edge_neighbor_iterator.
+class compressed_neighbor_iterator {
+        public:
+                // iterates over no_of_positive positive and then no_of_negative negative neighbors whose
+                // encodings start at data
+                compressed_neighbor_iterator(const uint8_t * data, NodeID node, EdgeID no_of_positive, EdgeID no_of_negative, bool unit_weights)
+                        : m_data(data), m_node(node), m_remaining(no_of_positive), m_next_group(no_of_negative),
+                          m_positive(no_of_positive > 0), m_unit_weights(unit_weights), m_target(0), m_weight(0) {
+                        if( m_remaining == 0 ) {
+                                m_remaining  = m_next_group;
+                                m_next_group = 0;
+                        }
+                        if( m_remaining > 0 ) decode_first();
+                };
+
+                inline bool done() const { return m_remaining == 0; };
+
+                inline void next() {
+                        if( --m_remaining > 0 ) {
+                                m_target += decode_varint(m_data);
+                                decode_weight();
+                        } else if( m_next_group > 0 ) {
+                                m_remaining  = m_next_group;
+                                m_next_group = 0;
+                                m_positive   = false;
+                                decode_first();
+                        }
+                };
+
+                inline NodeID target() const { return m_target; };
+                inline EdgeWeight weight() const { return m_weight; };
+
+        private:
+                inline void decode_first() {
+                        m_target = (NodeID)((int64_t)m_node + zigzag_decode(decode_varint(m_data)));
+                        decode_weight();
+                };
+
+                inline void decode_weight() {
+                        EdgeWeight magnitude = m_unit_weights ? 1 : (EdgeWeight)decode_varint(m_data);
+                        m_weight = m_positive ? magnitude : -magnitude;
+                };
+
+                const uint8_t * m_data;
+                NodeID          m_node;
+                EdgeID          m_remaining;
+                EdgeID          m_next_group;
+                bool            m_positive;
+                bool            m_unit_weights;
+                NodeID          m_target;
+                EdgeWeight      m_weight;
+};
+
+// Read only adjacency structure with gap encoded neighborhoods, plus the partition of the nodes.
+// The neighborhood of a node is stored as
+//      varint #positive edges, varint #negative edges, varint bytes of the positive edges,
+//      positive edges, negative edges
+// where both groups are sorted by target. The first target of a group is stored relative to the node
+// (zigzag), the following ones as gaps to their predecessor. Positive edges have weight > 0, negative
+// ones weight <= 0; the absolute weight follows every target as varint unless all weights are +-1, then
+// the weight is implied by the group. Node weights are only stored if they are not all one.
+//
+// The interface mirrors the part of graph_access that the clustering kernels need. Edges cannot be
+// accessed by id, neighborhoods are visited with forall_neighbors and friends. Without sign split the
+// positive range covers all neighbors, as for graph_access.
+class compressed_graph {
+        public:
+                compressed_graph();
+                virtual ~compressed_graph() {};
+
+                compressed_graph(const compressed_graph&) = delete;
+
+                void build(graph_access & G, bool sign_split, int num_threads);
+
+                // builds the graph without a plain copy: source(node, edges) appends the edges of node to
+                // edges and returns the weight of node. It is called twice per node, concurrently for
+                // different nodes. unit_weights tells whether all edge weights are +-1.
+                template <typename NeighborhoodSource>
+                void build(NodeID n, EdgeID m, bool sign_split, bool unit_weights, int num_threads,
+                           NeighborhoodSource & source);
+
+                NodeID number_of_nodes() const { return m_number_of_nodes; };
+                EdgeID number_of_edges() const { return m_number_of_edges; };
+
+                EdgeID getNodeDegree(NodeID node) const;
+                EdgeWeight getWeightedNodeDegree(NodeID node);
+
+                NodeWeight getNodeWeight(NodeID node) const;
+
+                PartitionID getPartitionIndex(NodeID node) const { return m_partition_index[node]; };
+                void setPartitionIndex(NodeID node, PartitionID id) { m_partition_index[node] = id; };
+
+                PartitionID getSecondPartitionIndex(NodeID node) const { return m_second_partition_index[node]; };
+                void setSecondPartitionIndex(NodeID node, PartitionID id) { m_second_partition_index[node] = id; };
+                void resizeSecondPartitionIndex(unsigned no_nodes) { m_second_partition_index.resize(no_nodes); };
+
+                PartitionID get_partition_count() const { return m_partition_count; };
+                void set_partition_count(PartitionID count) { m_partition_count = count; };
+
+                bool has_sign_split_edges() const { return m_sign_split; };
+                bool has_unit_weights() const { return m_unit_weights; };
+
+                compressed_neighbor_iterator neighbors(NodeID node) const;
+                compressed_neighbor_iterator positive_neighbors(NodeID node) const;
+                compressed_neighbor_iterator negative_neighbors(NodeID node) const;
+
+                EdgeWeight edge_cut(int num_threads);
+
+                size_t memory_in_bytes() const;
+
+        private:
+                // encodes the edges [begin, end), which are sorted by sign group and target, returns the number
+                // of bytes. out == NULL only counts
+                size_t encode_node(NodeID node, const Edge * begin, const Edge * end, uint8_t * out) const;
+
+                inline const uint8_t * read_header(NodeID node, EdgeID & no_of_positive, EdgeID & no_of_negative, size_t & positive_bytes) const {
+                        const uint8_t * data = &m_data[0] + m_offsets[node];
+                        no_of_positive = decode_varint(data);
+                        no_of_negative = decode_varint(data);
+                        positive_bytes = decode_varint(data);
+                        return data;
+                };
+
+                NodeID                   m_number_of_nodes;
+                EdgeID                   m_number_of_edges;
+                bool                     m_sign_split;
+                bool                     m_unit_weights;
+                PartitionID              m_partition_count;
+                std::vector<size_t>      m_offsets;     // n+1 byte offsets into m_data
+                std::vector<uint8_t>     m_data;
+                std::vector<NodeWeight>  m_node_weights; // empty if all node weights are one
+                std::vector<PartitionID> m_partition_index;
+                std::vector<PartitionID> m_second_partition_index;
+};
+
+template <typename NeighborhoodSource>
+void compressed_graph::build(NodeID n, EdgeID m, bool sign_split, bool unit_weights, int num_threads,
+                             NeighborhoodSource & source) {
+        num_threads       = std::max(1, num_threads);
+        m_number_of_nodes = n;
+        m_number_of_edges = m;
+        m_sign_split      = sign_split;
+        m_unit_weights    = unit_weights;
+        m_partition_count = 1;
+
+        // two passes over the sorted neighborhoods: sizes, prefix sum, encoding
+        bool unit_node_weights = true;
+        m_node_weights.resize(n);
+        m_offsets.assign(n+1, 0);
+        for( int pass = 0; pass < 2; pass++) {
+                #pragma omp parallel num_threads(num_threads) reduction(&&:unit_node_weights)
+                {
+                        std::vector<Edge> edges;
+
+                        #pragma omp for schedule(dynamic, 1024)
+                        for( NodeID node = 0; node < n; node++) {
+                                edges.clear();
+                                NodeWeight weight = source(node, edges);
+                                std::sort(edges.begin(), edges.end(), [](const Edge & lhs, const Edge & rhs) {
+                                        bool lhs_positive = lhs.weight > 0;
+                                        bool rhs_positive = rhs.weight > 0;
+                                        if( lhs_positive != rhs_positive ) return lhs_positive;
+                                        return lhs.target < rhs.target;
+                                });
+
+                                const Edge * begin = edges.data();
+                                if( pass == 0 ) {
+                                        m_offsets[node+1]    = encode_node(node, begin, begin + edges.size(), NULL);
+                                        m_node_weights[node] = weight;
+                                        unit_node_weights    = unit_node_weights && weight == 1;
+                                } else {
+                                        encode_node(node, begin, begin + edges.size(), &m_data[0] + m_offsets[node]);
+                                }
+                        }
+                }
+
+                if( pass == 0 ) {
+                        for( NodeID node = 0; node < n; node++) {
+                                m_offsets[node+1] += m_offsets[node];
+                        }
+                        m_data.assign(m_offsets[n] + 1, 0); // +1, the data pointer of an empty graph stays valid
+                }
+        }
+
+        if( unit_node_weights ) {
+                std::vector<NodeWeight>().swap(m_node_weights);
+        }
+        m_partition_index.assign(n, 0);
+        m_second_partition_index.clear();
+}
+
+inline EdgeID compressed_graph::getNodeDegree(NodeID node) const {
+        EdgeID no_of_positive, no_of_negative;
+        size_t positive_bytes;
+        read_header(node, no_of_positive, no_of_negative, positive_bytes);
+        return no_of_positive + no_of_negative;
+}
+
+inline EdgeWeight compressed_graph::getWeightedNodeDegree(NodeID node) {
+        EdgeWeight degree = 0;
+        forall_neighbors((*this), it, node) {
+                degree += it.weight();
+        } endfor
+        return degree;
+}
+
+inline NodeWeight compressed_graph::getNodeWeight(NodeID node) const {
+        return m_node_weights.empty() ? 1 : m_node_weights[node];
+}
+
+inline compressed_neighbor_iterator compressed_graph::neighbors(NodeID node) const {
+        EdgeID no_of_positive, no_of_negative;
+        size_t positive_bytes;
+        const uint8_t * data = read_header(node, no_of_positive, no_of_negative, positive_bytes);
+        return compressed_neighbor_iterator(data, node, no_of_positive, no_of_negative, m_unit_weights);
+}
+
+inline compressed_neighbor_iterator compressed_graph::positive_neighbors(NodeID node) const {
+        if( !m_sign_split ) return neighbors(node);
+
+        EdgeID no_of_positive, no_of_negative;
+        size_t positive_bytes;
+        const uint8_t * data = read_header(node, no_of_positive, no_of_negative, positive_bytes);
+        return compressed_neighbor_iterator(data, node, no_of_positive, 0, m_unit_weights);
+}
+
+inline compressed_neighbor_iterator compressed_graph::negative_neighbors(NodeID node) const {
+        EdgeID no_of_positive, no_of_negative;
+        size_t positive_bytes;
+        const uint8_t * data = read_header(node, no_of_positive, no_of_negative, positive_bytes);
+        if( !m_sign_split ) return compressed_neighbor_iterator(data, node, 0, 0, m_unit_weights);
+
+        return compressed_neighbor_iterator(data + positive_bytes, node, 0, no_of_negative, m_unit_weights);
+}
+
+#endif /* end of include guard: COMPRESSED_GRAPH_T6JD2LQ8 */
@@ -0,0 +1,141 @@
+/******************************************************************************
+ * cut_edge_list.h
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#ifndef CUT_EDGE_LIST_5HQW8ZPN
+#define CUT_EDGE_LIST_5HQW8ZPN
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "cut_edge_sketch.h"
+#include "definitions.h"
+#include "graph_access.h"
+
+// Sorted list of the cut edges of a clustering. Every undirected edge is represented once, by the
+// edge id of its direction from the smaller to the larger node. The ids are stored as differences
+// to their predecessor in a variable length byte code (7 bits per byte), i.e. one or two bytes per
+// cut edge on graphs with a reasonable node order. Optionally the list carries a MinHash sketch of
+// its set to estimate differences without decoding (see cut_edge_sketch).
+class cut_edge_list
+{
+        public:
+                cut_edge_list() : m_size(0) {};
+
+                // sequential decoding of the edge ids in increasing order
+                class iterator {
+                        public:
+                                iterator(const cut_edge_list & list) : m_byte(list.m_bytes.data()),
+                                                                       m_remaining(list.m_size), m_edge(0) {};
+
+                                inline bool done() const { return m_remaining == 0; };
+                                inline EdgeID remaining() const { return m_remaining; };
+                                inline EdgeID next() {
+                                        uint64_t delta = 0;
+                                        unsigned shift = 0;
+                                        while( *m_byte & 0x80 ) {
+                                                delta |= (uint64_t)(*m_byte++ & 0x7f) << shift;
+                                                shift += 7;
+                                        }
+                                        delta |= (uint64_t)(*m_byte++) << shift;
+                                        m_remaining--;
+                                        m_edge += delta;
+                                        return m_edge;
+                                };
+
+                        private:
+                                const uint8_t * m_byte;
+                                EdgeID          m_remaining;
+                                EdgeID          m_edge;
+                };
+
+                // the cut edges of the clustering partition_map of G, sketch_size 0 means no sketch
+                void build(graph_access & G, const int * partition_map, unsigned sketch_size = 0) {
+                        m_bytes.clear();
+                        m_size       = 0;
+                        EdgeID last  = 0;
+                        forall_nodes(G, node) {
+                                forall_out_edges(G, e, node) {
+                                        NodeID target = G.getEdgeTarget(e);
+                                        if( node < target && partition_map[node] != partition_map[target] ) {
+                                                append(e - last);
+                                                last = e;
+                                        }
+                                } endfor
+                        } endfor
+                        m_bytes.shrink_to_fit();
+                        m_sketch.build(iterator(*this), sketch_size);
+                };
+
+                // size of the symmetric difference of the cut edge sets of lhs and rhs
+                static EdgeID symmetric_difference_size(const cut_edge_list & lhs, const cut_edge_list & rhs) {
+                        iterator lhs_it(lhs);
+                        iterator rhs_it(rhs);
+                        EdgeID difference = 0;
+                        bool lhs_valid    = !lhs_it.done();
+                        bool rhs_valid    = !rhs_it.done();
+                        EdgeID lhs_edge   = lhs_valid ? lhs_it.next() : 0;
+                        EdgeID rhs_edge   = rhs_valid ? rhs_it.next() : 0;
+                        while( lhs_valid && rhs_valid ) {
+                                if( lhs_edge == rhs_edge ) {
+                                        lhs_valid = !lhs_it.done(); if( lhs_valid ) lhs_edge = lhs_it.next();
+                                        rhs_valid = !rhs_it.done(); if( rhs_valid ) rhs_edge = rhs_it.next();
+                                } else if( lhs_edge < rhs_edge ) {
+                                        difference++;
+                                        lhs_valid = !lhs_it.done(); if( lhs_valid ) lhs_edge = lhs_it.next();
+                                } else {
+                                        difference++;
+                                        rhs_valid = !rhs_it.done(); if( rhs_valid ) rhs_edge = rhs_it.next();
+                                }
+                        }
+                        // the remaining edges of the longer list, including the current one
+                        if( lhs_valid ) difference += 1 + lhs_it.remaining();
+                        if( rhs_valid ) difference += 1 + rhs_it.remaining();
+                        return difference;
+                };
+
+                // appends the encoded list to buffer, read restores it (and builds its sketch) and returns
+                // the end of the data
+                void write(std::vector<uint8_t> & buffer) const {
+                        uint64_t header[2] = {m_size, m_bytes.size()};
+                        size_t offset      = buffer.size();
+                        buffer.resize(offset + sizeof(header) + m_bytes.size());
+                        memcpy(&buffer[offset], header, sizeof(header));
+                        if( !m_bytes.empty() ) {
+                                memcpy(&buffer[offset + sizeof(header)], m_bytes.data(), m_bytes.size());
+                        }
+                };
+
+                const uint8_t * read(const uint8_t * buffer, unsigned sketch_size = 0) {
+                        uint64_t header[2];
+                        memcpy(header, buffer, sizeof(header));
+                        m_size = header[0];
+                        m_bytes.assign(buffer + sizeof(header), buffer + sizeof(header) + header[1]);
+                        m_sketch.build(iterator(*this), sketch_size);
+                        return buffer + sizeof(header) + header[1];
+                };
+
+                EdgeID size() const { return m_size; };
+                const cut_edge_sketch & sketch() const { return m_sketch; };
+                size_t memory_in_bytes() const { return m_bytes.capacity() + m_sketch.memory_in_bytes(); };
+
+        private:
+                inline void append(uint64_t delta) {
+                        while( delta >= 0x80 ) {
+                                m_bytes.push_back((uint8_t)(delta | 0x80));
+                                delta >>= 7;
+                        }
+                        m_bytes.push_back((uint8_t)delta);
+                        m_size++;
+                };
+
+                std::vector<uint8_t> m_bytes;
+                EdgeID               m_size;
+                cut_edge_sketch      m_sketch;
+};
+
+#endif /* end of include guard: CUT_EDGE_LIST_5HQW8ZPN */
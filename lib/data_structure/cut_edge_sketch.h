@@ -0,0 +1,131 @@
+/******************************************************************************
+ * cut_edge_sketch.h
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#ifndef CUT_EDGE_SKETCH_M3TJ8QVD
+#define CUT_EDGE_SKETCH_M3TJ8QVD
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include <vector>
+
+#include "definitions.h"
+#include "random_functions.h"
+
+// Bottom-k MinHash sketch of a set of edge ids: the k smallest hash values of the ids, sorted. The
+// hash function is the same for all sketches, so two sketches estimate the Jaccard similarity and
+// thereby the size of the symmetric difference of their sets in O(k) time. Sets with fewer than k
+// elements are represented completely and compared exactly (up to 64 bit hash collisions).
+class cut_edge_sketch
+{
+        public:
+                cut_edge_sketch() : m_sketch_size(0), m_set_size(0) {};
+
+                // the set consists of the edge ids returned by it, any iterator with done() and next()
+                template <typename Iterator>
+                void build(Iterator it, unsigned sketch_size) {
+                        m_sketch_size = sketch_size;
+                        m_set_size    = 0;
+                        m_hashes.clear();
+                        if( sketch_size == 0 ) return;
+
+                        std::priority_queue<uint64_t> smallest; // max heap of the k smallest hashes
+                        while( !it.done() ) {
+                                uint64_t hash = hash_edge(it.next());
+                                m_set_size++;
+                                if( smallest.size() < sketch_size ) {
+                                        smallest.push(hash);
+                                } else if( hash < smallest.top() ) {
+                                        smallest.pop();
+                                        smallest.push(hash);
+                                }
+                        }
+
+                        m_hashes.resize(smallest.size());
+                        for( size_t i = smallest.size(); i > 0; i--) {
+                                m_hashes[i-1] = smallest.top();
+                                smallest.pop();
+                        }
+                };
+
+                bool empty() const { return m_sketch_size == 0; };
+                bool is_exact() const { return m_hashes.size() == m_set_size; };
+
+                // estimated size of the symmetric difference of the sets of lhs and rhs (same sketch size).
+                // standard_error is the standard error of the estimate, zero if both sets are complete.
+                static double estimate_symmetric_difference(const cut_edge_sketch & lhs, const cut_edge_sketch & rhs,
+                                                            double & standard_error) {
+                        const double set_sizes = (double)lhs.m_set_size + rhs.m_set_size;
+                        standard_error         = 0;
+                        if( set_sizes == 0 ) return 0;
+
+                        // the k smallest hashes of the union and how many of them are in both sets. complete sets
+                        // are merged completely, their union may have more than k elements
+                        const bool exact = lhs.is_exact() && rhs.is_exact();
+                        const size_t k   = exact ? lhs.m_hashes.size() + rhs.m_hashes.size()
+                                                 : std::max(lhs.m_sketch_size, rhs.m_sketch_size);
+                        size_t i = 0, j = 0, union_size = 0, intersection = 0;
+                        while( union_size < k && (i < lhs.m_hashes.size() || j < rhs.m_hashes.size()) ) {
+                                if( j == rhs.m_hashes.size() || (i < lhs.m_hashes.size() && lhs.m_hashes[i] < rhs.m_hashes[j]) ) {
+                                        i++;
+                                } else if( i == lhs.m_hashes.size() || rhs.m_hashes[j] < lhs.m_hashes[i] ) {
+                                        j++;
+                                } else {
+                                        i++; j++;
+                                        intersection++;
+                                }
+                                union_size++;
+                        }
+
+                        if( exact ) {
+                                return set_sizes - 2.0*intersection;
+                        }
+
+                        double jaccard = (double)intersection / union_size;
+                        standard_error = 2.0 * set_sizes * sqrt(jaccard*(1-jaccard)/union_size) / ((1+jaccard)*(1+jaccard));
+                        // |A ^ B| = (|A| + |B|) * (1 - J) / (1 + J)
+                        return set_sizes * (1-jaccard) / (1+jaccard);
+                };
+
+                // positions of the sketches whose sets may be the most similar to the one of query: the one
+                // with the smallest estimate and, if verify, all whose estimate minus two standard errors does
+                // not exceed the smallest estimate (the caller measures these exactly)
+                static void select_most_similar(const std::vector<const cut_edge_sketch*> & sketches,
+                                                const cut_edge_sketch & query, bool verify,
+                                                std::vector<unsigned> & selected) {
+                        std::vector<double> estimate(sketches.size());
+                        std::vector<double> error(sketches.size());
+                        double min_estimate = std::numeric_limits<double>::max();
+                        for( unsigned c = 0; c < sketches.size(); c++) {
+                                estimate[c]  = estimate_symmetric_difference(*sketches[c], query, error[c]);
+                                min_estimate = std::min(min_estimate, estimate[c]);
+                        }
+
+                        selected.clear();
+                        for( unsigned c = 0; c < sketches.size(); c++) {
+                                if( verify ? estimate[c] - 2*error[c] <= min_estimate : estimate[c] == min_estimate ) {
+                                        selected.push_back(c);
+                                        if( !verify ) break;
+                                }
+                        }
+                };
+
+                size_t memory_in_bytes() const { return m_hashes.capacity()*sizeof(uint64_t); };
+
+        private:
+                static inline uint64_t hash_edge(EdgeID e) {
+                        return random_functions::counter_based(0x5DEECE66Dull, e, 0);
+                };
+
+                std::vector<uint64_t> m_hashes;
+                unsigned              m_sketch_size;
+                EdgeID                m_set_size;
+};
+
+#endif /* end of include guard: CUT_EDGE_SKETCH_M3TJ8QVD */
@@ -8,6 +8,7 @@
 #ifndef GRAPH_ACCESS_EFRXO4X2
 #define GRAPH_ACCESS_EFRXO4X2
 
+#include <algorithm>
 #include <bitset>
 #include <cassert>
 #include <iostream>
@@ -15,6 +16,7 @@
 #include <cmath>
 
 #include "definitions.h"
+#include "data_structure/graph_storage.h"
 
 struct Node {
     EdgeID firstEdge;
@@ -35,6 +37,58 @@ struct coarseningEdge {
     EdgeRatingType rating;
 };
 
+// Property policies of the graph. The edge ratings and contraction offsets are only used by the
+// coarsening of the partitioner, the clustering targets are built with LEAN_GRAPH_ACCESS and leave
+// them out, i.e. they save sizeof(coarseningEdge) bytes per edge and a NodeWeight per node on
+// every level of the hierarchy. The accessors of disabled properties do not exist.
+struct full_graph_properties {
+    static const bool edge_ratings        = true;
+    static const bool contraction_offsets = true;
+};
+
+struct lean_graph_properties {
+    static const bool edge_ratings        = false;
+    static const bool contraction_offsets = false;
+};
+
+#ifdef LEAN_GRAPH_ACCESS
+typedef lean_graph_properties graph_properties;
+#else
+typedef full_graph_properties graph_properties;
+#endif
+
+// property array that is only stored if the policy enables it
+template <typename T, bool enabled>
+class property_array : public std::vector<T> {
+};
+
+template <typename T>
+class property_array<T, false> {
+public:
+    void assign(size_t, const T &) {}
+    void resize(size_t) {}
+    void resize(size_t, const T &) {}
+    size_t size() const { return 0; }
+    size_t capacity() const { return 0; }
+};
+
+// (target, weight) pairs of a range of edges. compressed_graph offers an iterator with the same
+// interface, kernels that only need the neighborhood of a node can be written for both graph types
+// with forall_neighbors and friends.
+class edge_neighbor_iterator {
+public:
+    edge_neighbor_iterator(const Edge * begin, const Edge * end) : m_edge(begin), m_end(end) {}
+
+    inline bool done() const { return m_edge == m_end; }
+    inline void next() { ++m_edge; }
+    inline NodeID target() const { return m_edge->target; }
+    inline EdgeWeight weight() const { return m_edge->weight; }
+
+private:
+    const Edge * m_edge;
+    const Edge * m_end;
+};
+
 class graph_access;
 
 //construction etc. is encapsulated in basicGraph / access to properties etc. is encapsulated in graph_access
@@ -70,13 +124,14 @@ private:
         e                = 0;
         m_last_source    = -1;
 
-        //resizes property arrays
+        //resizes property arrays, the properties are reset since the graph may be reused
         m_nodes.resize(n+1);
-        m_refinement_node_props.resize(n+1);
+        m_refinement_node_props.assign(n+1, refinementNode());
         m_edges.resize(m);
-        m_coarsening_edge_props.resize(m);
+        m_coarsening_edge_props.assign(m, coarseningEdge());
 
-        m_contraction_offset.resize(n+1, 0);
+        m_contraction_offset.assign(n+1, 0);
+        m_first_negative_edge.clear();
 
         m_nodes[node].firstEdge = e;
     }
@@ -110,6 +165,36 @@ private:
         return node++;
     }
 
+    // construction of the graph when the first edges of all nodes are known in advance,
+    // the arrays are then filled directly (possibly by several threads)
+    void start_bulk_construction(NodeID n, EdgeID m) {
+        start_construction(n, m);
+        node          = n;
+        e             = m;
+        m_last_source = n-1;
+    }
+
+    void finish_bulk_construction() {
+        m_nodes[node].firstEdge = e;
+        m_building_graph        = false;
+    }
+
+    // use n+1 nodes (including the sentinel) and m edges that live in external memory
+    void attach_external(Node * nodes, NodeID n, Edge * edges, EdgeID m, std::shared_ptr<void> owner) {
+        m_nodes.attach(nodes, n+1, owner);
+        m_edges.attach(edges, m, owner);
+
+        m_refinement_node_props.assign(n+1, refinementNode());
+        m_coarsening_edge_props.assign(m, coarseningEdge());
+        m_contraction_offset.assign(n+1, 0);
+        m_first_negative_edge.clear();
+
+        m_building_graph = false;
+        node             = n;
+        e                = m;
+        m_last_source    = n-1;
+    }
+
     void finish_construction() {
         // inert dummy node
         m_nodes.resize(node+1);
@@ -133,14 +218,18 @@ private:
 
     // %%%%%%%%%%%%%%%%%%% DATA %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
     // split properties for coarsening and uncoarsening
-    std::vector<Node> m_nodes;
-    std::vector<Edge> m_edges;
+    graph_storage<Node> m_nodes;
+    graph_storage<Edge> m_edges;
     
     std::vector<refinementNode> m_refinement_node_props;
-    std::vector<coarseningEdge> m_coarsening_edge_props;
+    property_array<coarseningEdge, graph_properties::edge_ratings> m_coarsening_edge_props;
 
     // Offsets for computing sizes of reachable sets for contracted nodes
-    std::vector<NodeWeight> m_contraction_offset;
+    property_array<NodeWeight, graph_properties::contraction_offsets> m_contraction_offset;
+
+    // optional sign split layout: the edges of a node with positive weight come first,
+    // m_first_negative_edge[node] is the first edge with weight <= 0. empty if not used
+    std::vector<EdgeID> m_first_negative_edge;
         
     // construction properties
     bool m_building_graph;
@@ -153,6 +242,11 @@ private:
 #define forall_edges(G,e) { for(EdgeID e = 0, end = G.number_of_edges(); e < end; ++e) {
 #define forall_nodes(G,n) { for(NodeID n = 0, end = G.number_of_nodes(); n < end; ++n) {
 #define forall_out_edges(G,e,n) { for(EdgeID e = G.get_first_edge(n), end = G.get_first_invalid_edge(n); e < end; ++e) {
+#define forall_positive_out_edges(G,e,n) { for(EdgeID e = G.get_first_edge(n), end = G.get_first_negative_edge(n); e < end; ++e) {
+#define forall_negative_out_edges(G,e,n) { for(EdgeID e = G.get_first_negative_edge(n), end = G.get_first_invalid_edge(n); e < end; ++e) {
+#define forall_neighbors(G,it,n) { for(auto it = G.neighbors(n); !it.done(); it.next()) {
+#define forall_positive_neighbors(G,it,n) { for(auto it = G.positive_neighbors(n); !it.done(); it.next()) {
+#define forall_negative_neighbors(G,it,n) { for(auto it = G.negative_neighbors(n); !it.done(); it.next()) {
 #define forall_out_edges_starting_at(G,e,n,e_bar) { for(EdgeID e = e_bar, end = G.get_first_invalid_edge(n); e < end; ++e) {
 #define forall_blocks(G,p) { for (PartitionID p = 0, end = G.get_partition_count(); p < end; p++) {
 #define endfor }}
@@ -176,6 +270,24 @@ class graph_access {
                 EdgeID new_edge(NodeID source, NodeID target);
                 void finish_construction();
 
+                // the caller sets the first edge of every node and every edge explicitly, 
+                // different nodes/edges can be set concurrently
+                void start_bulk_construction(NodeID nodes, EdgeID edges);
+                void set_first_edge(NodeID node, EdgeID edge);
+                void set_edge(EdgeID edge, NodeID target, EdgeWeight weight);
+                void finish_bulk_construction();
+
+                // the graph uses the node array (n+1 entries, the last one is the sentinel) and the
+                // edge array without copying them, owner keeps the memory alive as long as it is used
+                void attach_external_graph(Node * nodes, NodeID n, Edge * edges, EdgeID m, std::shared_ptr<void> owner);
+
+                // the graph uses the node and edge arrays (and the sign split layout) of G without copying
+                // them, the partition arrays are its own. G has to outlive the graph and keep its edges
+                void share_topology(graph_access & G);
+
+                // frees all memory of the graph, it has to be rebuilt before it is used again
+                void release_memory();
+
                 /* ============================================================= */
                 /* graph access methods */
                 /* ============================================================= */
@@ -185,6 +297,21 @@ class graph_access {
                 EdgeID get_first_edge(NodeID node);
                 EdgeID get_first_invalid_edge(NodeID node);
 
+                // sign split layout, see forall_positive_out_edges/forall_negative_out_edges. without it
+                // all edges of a node count as positive, i.e. the first negative edge is the first invalid one
+                bool has_sign_split_edges();
+                EdgeID get_first_negative_edge(NodeID node);
+                void start_sign_split_edges();
+                void set_first_negative_edge(NodeID node, EdgeID edge);
+                // reorders the edges of every node, the edge ratings are not preserved. edges that are
+                // already split are not written
+                void split_edges_by_sign(int num_threads);
+
+                // neighborhood iteration, see forall_neighbors
+                edge_neighbor_iterator neighbors(NodeID node);
+                edge_neighbor_iterator positive_neighbors(NodeID node);
+                edge_neighbor_iterator negative_neighbors(NodeID node);
+
                 PartitionID get_partition_count(); 
                 void set_partition_count(PartitionID count); 
 
@@ -212,12 +339,20 @@ class graph_access {
 
                 NodeID getEdgeTarget(EdgeID edge);
 
+#ifndef LEAN_GRAPH_ACCESS
                 EdgeRatingType getEdgeRating(EdgeID edge);
                 void setEdgeRating(EdgeID edge, EdgeRatingType rating);
 
                 // access the contraction offset of a node
                 NodeWeight get_contraction_offset(NodeID node) const;
                 void set_contraction_offset(NodeID node, NodeWeight offset);
+#endif
+
+                // memory of the graph arrays (external arrays included)
+                size_t memory_in_bytes();
+
+                // number of edges the graph can be rebuilt with without reallocating
+                EdgeID edge_capacity();
 
                 int* UNSAFE_metis_style_xadj_array();
                 int* UNSAFE_metis_style_adjncy_array();
@@ -242,6 +377,7 @@ class graph_access {
 };
 
 
+#ifndef LEAN_GRAPH_ACCESS
 inline NodeWeight graph_access::get_contraction_offset(NodeID node) const {
         return graphref->m_contraction_offset[node];
 }
@@ -249,12 +385,24 @@ inline NodeWeight graph_access::get_contraction_offset(NodeID node) const {
 inline void graph_access::set_contraction_offset(NodeID node, NodeWeight offset) {
         graphref->m_contraction_offset[node] = offset;
 }
+#endif
+
+inline size_t graph_access::memory_in_bytes() {
+        return graphref->m_nodes.size()*sizeof(Node)
+               + graphref->m_edges.size()*sizeof(Edge)
+               + graphref->m_refinement_node_props.capacity()*sizeof(refinementNode)
+               + graphref->m_coarsening_edge_props.capacity()*sizeof(coarseningEdge)
+               + graphref->m_contraction_offset.capacity()*sizeof(NodeWeight)
+               + graphref->m_first_negative_edge.capacity()*sizeof(EdgeID)
+               + m_second_partition_index.capacity()*sizeof(PartitionID);
+}
 
 
 
 /* graph build methods */
 inline void graph_access::start_construction(NodeID nodes, EdgeID edges) {
         graphref->start_construction(nodes, edges);
+        m_max_degree_computed = false;
 }
 
 inline NodeID graph_access::new_node() {
@@ -269,6 +417,45 @@ inline void graph_access::finish_construction() {
         graphref->finish_construction();
 }
 
+inline void graph_access::start_bulk_construction(NodeID nodes, EdgeID edges) {
+        graphref->start_bulk_construction(nodes, edges);
+        m_max_degree_computed = false;
+}
+
+inline void graph_access::set_first_edge(NodeID node, EdgeID edge) {
+        graphref->m_nodes[node].firstEdge = edge;
+}
+
+inline void graph_access::set_edge(EdgeID edge, NodeID target, EdgeWeight weight) {
+        graphref->m_edges[edge].target = target;
+        graphref->m_edges[edge].weight = weight;
+}
+
+inline void graph_access::release_memory() {
+        delete graphref;
+        graphref              = new basicGraph();
+        m_max_degree_computed = false;
+}
+
+inline void graph_access::finish_bulk_construction() {
+        graphref->finish_bulk_construction();
+}
+
+inline void graph_access::attach_external_graph(Node * nodes, NodeID n, Edge * edges, EdgeID m, std::shared_ptr<void> owner) {
+        graphref->attach_external(nodes, n, edges, m, owner);
+        m_max_degree_computed = false;
+}
+
+inline void graph_access::share_topology(graph_access & G) {
+        // aliasing constructor, the owner is not empty but does not own the arrays
+        std::shared_ptr<void> owner(std::shared_ptr<void>(), G.graphref);
+        graphref->attach_external(G.graphref->m_nodes.data(), G.number_of_nodes(), 
+                                  G.graphref->m_edges.data(), G.number_of_edges(), owner);
+        graphref->m_first_negative_edge = G.graphref->m_first_negative_edge;
+        m_partition_count     = G.m_partition_count;
+        m_max_degree_computed = false;
+}
+
 /* graph access methods */
 inline NodeID graph_access::number_of_nodes() {
         return graphref->number_of_nodes();
@@ -278,6 +465,10 @@ inline EdgeID graph_access::number_of_edges() {
         return graphref->number_of_edges();
 }
 
+inline EdgeID graph_access::edge_capacity() {
+        return graphref->m_edges.capacity();
+}
+
 inline void graph_access::resizeSecondPartitionIndex(unsigned no_nodes) {
         m_second_partition_index.resize(no_nodes);
 }
@@ -294,6 +485,59 @@ inline EdgeID graph_access::get_first_invalid_edge(NodeID node) {
         return graphref->m_nodes[node+1].firstEdge;
 }
 
+inline bool graph_access::has_sign_split_edges() {
+        return !graphref->m_first_negative_edge.empty();
+}
+
+inline EdgeID graph_access::get_first_negative_edge(NodeID node) {
+        if(graphref->m_first_negative_edge.empty()) {
+                return graphref->m_nodes[node+1].firstEdge;
+        }
+        return graphref->m_first_negative_edge[node];
+}
+
+inline void graph_access::start_sign_split_edges() {
+        graphref->m_first_negative_edge.resize(number_of_nodes());
+}
+
+inline void graph_access::set_first_negative_edge(NodeID node, EdgeID edge) {
+        graphref->m_first_negative_edge[node] = edge;
+}
+
+inline void graph_access::split_edges_by_sign(int num_threads) {
+        NodeID n = number_of_nodes();
+        start_sign_split_edges();
+
+        #pragma omp parallel for num_threads(std::max(1, num_threads)) schedule(dynamic, 1024)
+        for( NodeID node = 0; node < n; node++) {
+                graphref->m_first_negative_edge[node] = get_first_edge(node);
+                if( getNodeDegree(node) == 0 ) continue;
+
+                // edges that are already split are only read, they may be shared with other processes
+                auto positive = [](const Edge & edge) { return edge.weight > 0; };
+                Edge * begin  = &graphref->m_edges[get_first_edge(node)];
+                Edge * end    = begin + getNodeDegree(node);
+                Edge * split  = std::is_partitioned(begin, end, positive) ? std::partition_point(begin, end, positive)
+                                                                           : std::stable_partition(begin, end, positive);
+                graphref->m_first_negative_edge[node] += split - begin;
+        }
+}
+
+inline edge_neighbor_iterator graph_access::neighbors(NodeID node) {
+        const Edge * edges = graphref->m_edges.data();
+        return edge_neighbor_iterator(edges + get_first_edge(node), edges + get_first_invalid_edge(node));
+}
+
+inline edge_neighbor_iterator graph_access::positive_neighbors(NodeID node) {
+        const Edge * edges = graphref->m_edges.data();
+        return edge_neighbor_iterator(edges + get_first_edge(node), edges + get_first_negative_edge(node));
+}
+
+inline edge_neighbor_iterator graph_access::negative_neighbors(NodeID node) {
+        const Edge * edges = graphref->m_edges.data();
+        return edge_neighbor_iterator(edges + get_first_negative_edge(node), edges + get_first_invalid_edge(node));
+}
+
 inline PartitionID graph_access::get_partition_count() {
         return m_partition_count;
 }
@@ -381,6 +625,7 @@ inline NodeID graph_access::getEdgeTarget(EdgeID edge){
 #endif
 }
 
+#ifndef LEAN_GRAPH_ACCESS
 inline EdgeRatingType graph_access::getEdgeRating(EdgeID edge) {
 #ifdef NDEBUG
         return graphref->m_coarsening_edge_props[edge].rating;        
@@ -396,6 +641,7 @@ inline void graph_access::setEdgeRating(EdgeID edge, EdgeRatingType rating){
         graphref->m_coarsening_edge_props.at(edge).rating = rating;
 #endif
 }
+#endif
 
 inline EdgeWeight graph_access::getNodeDegree(NodeID node) {
         return graphref->m_nodes[node+1].firstEdge-graphref->m_nodes[node].firstEdge;
@@ -0,0 +1,65 @@
+/******************************************************************************
+ * graph_storage.h
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#ifndef GRAPH_STORAGE_K3XW9Q2D
+#define GRAPH_STORAGE_K3XW9Q2D
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// Array of nodes or edges of a basicGraph. The elements are either owned by the array or live in
+// external memory, e.g. a memory mapped binary graph file, that is kept alive by a shared owner.
+// External arrays cannot be resized, they are replaced by owned arrays once the graph is rebuilt.
+template <typename T>
+class graph_storage {
+        public:
+                graph_storage() : m_data(NULL), m_size(0) {};
+
+                inline size_t size() const { return m_size; };
+                inline size_t capacity() const { return m_external_owner ? m_size : m_owned.capacity(); };
+                inline T * data() { return m_data; };
+
+                inline T & operator[](size_t i) { return m_data[i]; };
+                inline const T & operator[](size_t i) const { return m_data[i]; };
+
+                inline T & at(size_t i) {
+                        if( i >= m_size ) throw std::out_of_range("graph_storage::at");
+                        return m_data[i];
+                };
+
+                void resize(size_t size) {
+                        if( m_external_owner ) {
+                                // copy once, then continue with an owned array
+                                std::vector<T> owned(m_data, m_data + std::min(size, m_size));
+                                m_external_owner.reset();
+                                m_owned.swap(owned);
+                        }
+                        m_owned.resize(size);
+                        m_data = m_owned.data();
+                        m_size = size;
+                };
+
+                // refer to size elements at data, owner has to keep the memory alive
+                void attach(T * data, size_t size, std::shared_ptr<void> owner) {
+                        std::vector<T>().swap(m_owned);
+                        m_external_owner = owner;
+                        m_data           = data;
+                        m_size           = size;
+                };
+
+                bool is_external() const { return (bool) m_external_owner; };
+
+        private:
+                T *                   m_data;
+                size_t                m_size;
+                std::vector<T>        m_owned;
+                std::shared_ptr<void> m_external_owner;
+};
+
+#endif /* end of include guard: GRAPH_STORAGE_K3XW9Q2D */
@@ -0,0 +1,116 @@
+/******************************************************************************
+ * packed_partition.h
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#ifndef PACKED_PARTITION_R7KD2XWA
+#define PACKED_PARTITION_R7KD2XWA
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "definitions.h"
+#include "graph_access.h"
+
+// Cluster id of every node with as many bits per node as the number of clusters needs. The cluster
+// ids are renumbered in the order of their first appearance, the clustering itself is unchanged.
+class packed_partition
+{
+        public:
+                packed_partition() : m_number_of_nodes(0), m_number_of_clusters(0), m_bits(1) {};
+
+                // partition_map holds a nonnegative cluster id for each of the n nodes
+                void pack(const int * partition_map, NodeID n) {
+                        int max_id = 0;
+                        for( NodeID node = 0; node < n; node++) {
+                                max_id = std::max(max_id, partition_map[node]);
+                        }
+
+                        std::vector<PartitionID> dense_id(max_id + 1, INVALID_PARTITION);
+                        m_number_of_clusters = 0;
+                        for( NodeID node = 0; node < n; node++) {
+                                if( dense_id[partition_map[node]] == INVALID_PARTITION ) {
+                                        dense_id[partition_map[node]] = m_number_of_clusters++;
+                                }
+                        }
+
+                        m_number_of_nodes = n;
+                        m_bits            = 1;
+                        while( m_bits < 32 && ((uint64_t)1 << m_bits) < m_number_of_clusters ) m_bits++;
+                        m_words.assign(((uint64_t)n * m_bits + 63) / 64, 0);
+
+                        for( NodeID node = 0; node < n; node++) {
+                                uint64_t value  = dense_id[partition_map[node]];
+                                uint64_t offset = (uint64_t)node * m_bits;
+                                unsigned shift  = offset & 63;
+                                m_words[offset >> 6] |= value << shift;
+                                if( shift + m_bits > 64 ) {
+                                        m_words[(offset >> 6) + 1] |= value >> (64 - shift);
+                                }
+                        }
+                };
+
+                inline PartitionID operator[](NodeID node) const {
+                        uint64_t offset = (uint64_t)node * m_bits;
+                        unsigned shift  = offset & 63;
+                        uint64_t value  = m_words[offset >> 6] >> shift;
+                        if( shift + m_bits > 64 ) {
+                                value |= m_words[(offset >> 6) + 1] << (64 - shift);
+                        }
+                        return value & (((uint64_t)1 << m_bits) - 1);
+                };
+
+                // sets the partition index of every node of G
+                void unpack(graph_access & G) const {
+                        forall_nodes(G, node) {
+                                G.setPartitionIndex(node, (*this)[node]);
+                        } endfor
+                };
+
+                void unpack(int * partition_map) const {
+                        for( NodeID node = 0; node < m_number_of_nodes; node++) {
+                                partition_map[node] = (*this)[node];
+                        }
+                };
+
+                // appends the packed ids to buffer, read restores them and returns the end of the data
+                void write(std::vector<uint8_t> & buffer) const {
+                        uint64_t header[4] = {m_number_of_nodes, m_number_of_clusters, m_bits, m_words.size()};
+                        size_t offset      = buffer.size();
+                        buffer.resize(offset + sizeof(header) + m_words.size()*sizeof(uint64_t));
+                        memcpy(&buffer[offset], header, sizeof(header));
+                        if( !m_words.empty() ) {
+                                memcpy(&buffer[offset + sizeof(header)], m_words.data(), m_words.size()*sizeof(uint64_t));
+                        }
+                };
+
+                const uint8_t * read(const uint8_t * buffer) {
+                        uint64_t header[4];
+                        memcpy(header, buffer, sizeof(header));
+                        m_number_of_nodes    = header[0];
+                        m_number_of_clusters = header[1];
+                        m_bits               = header[2];
+                        m_words.resize(header[3]);
+                        if( !m_words.empty() ) {
+                                memcpy(m_words.data(), buffer + sizeof(header), m_words.size()*sizeof(uint64_t));
+                        }
+                        return buffer + sizeof(header) + m_words.size()*sizeof(uint64_t);
+                };
+
+                NodeID number_of_nodes() const { return m_number_of_nodes; };
+                PartitionID number_of_clusters() const { return m_number_of_clusters; };
+                unsigned bits_per_node() const { return m_bits; };
+                size_t memory_in_bytes() const { return m_words.capacity()*sizeof(uint64_t); };
+
+        private:
+                std::vector<uint64_t> m_words;
+                NodeID                m_number_of_nodes;
+                PartitionID           m_number_of_clusters;
+                unsigned              m_bits;
+};
+
+#endif /* end of include guard: PACKED_PARTITION_R7KD2XWA */
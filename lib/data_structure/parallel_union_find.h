@@ -0,0 +1,60 @@
+/******************************************************************************
+ * parallel_union_find.h
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#ifndef PARALLEL_UNION_FIND_Q8MZ3KTE
+#define PARALLEL_UNION_FIND_Q8MZ3KTE
+
+#include <algorithm>
+#include <vector>
+
+#include "definitions.h"
+
+// Lock free union-find for concurrent Union calls. A root is always linked below the smaller one of
+// the two roots (by compare and swap), hence the representative of a set is its smallest element,
+// independently of the number of threads and the order of the Union calls. Find compresses paths by
+// halving.
+class parallel_union_find
+{
+        public:
+                parallel_union_find(NodeID n) : m_parent(n) {
+                        for( NodeID i = 0; i < n; i++) {
+                                m_parent[i] = i;
+                        }
+                };
+
+                inline void Union(NodeID lhs, NodeID rhs) {
+                        while( true ) {
+                                lhs = Find(lhs);
+                                rhs = Find(rhs);
+                                if( lhs == rhs ) return;
+                                if( lhs < rhs ) std::swap(lhs, rhs);
+
+                                // lhs is the larger root, it fails to link if another thread linked it in the meantime
+                                NodeID expected = lhs;
+                                if( __atomic_compare_exchange_n(&m_parent[lhs], &expected, rhs, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED) ) {
+                                        return;
+                                }
+                        }
+                };
+
+                inline NodeID Find(NodeID element) {
+                        NodeID parent = __atomic_load_n(&m_parent[element], __ATOMIC_RELAXED);
+                        while( parent != element ) {
+                                NodeID grandparent = __atomic_load_n(&m_parent[parent], __ATOMIC_RELAXED);
+                                // path halving, a concurrent link of parent only makes the write less useful
+                                __atomic_store_n(&m_parent[element], grandparent, __ATOMIC_RELAXED);
+                                element = parent;
+                                parent  = grandparent;
+                        }
+                        return element;
+                };
+
+        private:
+                std::vector< NodeID > m_parent;
+};
+
+#endif /* end of include guard: PARALLEL_UNION_FIND_Q8MZ3KTE */
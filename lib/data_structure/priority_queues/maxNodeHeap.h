@@ -54,7 +54,7 @@ class QElement {
 
 };
 
-class maxNodeHeap : public priority_queue_interface {
+class maxNodeHeap final : public priority_queue_interface {
         public:
 
                 struct Data {
@@ -0,0 +1,105 @@
+/******************************************************************************
+ * rating_map.h
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#ifndef RATING_MAP_Q2M8TZ0L
+#define RATING_MAP_Q2M8TZ0L
+
+#include <vector>
+
+#include "definitions.h"
+
+// Small open addressing hash table that accumulates edge weights per cluster.
+// It is meant to be owned by a single thread and to be reused for every node:
+// call prepare(degree) before rating the neighborhood of a node and clear()
+// afterwards. Only touched slots are reset, so the cost per node is O(degree).
+class rating_map {
+        public:
+                rating_map() : m_mask(0) {
+                        resize(64);
+                };
+                virtual ~rating_map() {};
+
+                // make sure that up to no_of_keys distinct keys fit into the table
+                inline void prepare(EdgeID no_of_keys) {
+                        size_t required = 2*(size_t)no_of_keys;
+                        if( required > m_keys.size() ) {
+                                size_t capacity = m_keys.size();
+                                while( capacity < required ) capacity *= 2;
+                                resize(capacity);
+                        }
+                };
+
+                inline void add(NodeID key, EdgeWeight value) {
+                        size_t pos = find_slot(key);
+                        if( m_keys[pos] == UNDEFINED_NODE ) {
+                                m_keys[pos]   = key;
+                                m_values[pos] = value;
+                                m_touched.push_back(pos);
+                        } else {
+                                m_values[pos] += value;
+                        }
+                };
+
+                // only accumulates if the key is already stored, used to add the negative edges
+                // of a node to the clusters that were rated by its positive edges
+                inline void add_if_contained(NodeID key, EdgeWeight value) {
+                        size_t pos = find_slot(key);
+                        if( m_keys[pos] != UNDEFINED_NODE ) {
+                                m_values[pos] += value;
+                        }
+                };
+
+                inline EdgeWeight get(NodeID key) {
+                        size_t pos = find_slot(key);
+                        return m_keys[pos] == UNDEFINED_NODE ? 0 : m_values[pos];
+                };
+
+                // iteration over the keys that are currently stored in the map
+                inline size_t size() const { return m_touched.size(); };
+                inline NodeID key_at(size_t i) const { return m_keys[m_touched[i]]; };
+                inline EdgeWeight value_at(size_t i) const { return m_values[m_touched[i]]; };
+
+                inline void clear() {
+                        for( size_t i = 0; i < m_touched.size(); i++) {
+                                m_keys[m_touched[i]] = UNDEFINED_NODE;
+                        }
+                        m_touched.clear();
+                };
+
+                size_t memory_in_bytes() const {
+                        return m_keys.capacity()*sizeof(NodeID)
+                               + m_values.capacity()*sizeof(EdgeWeight)
+                               + m_touched.capacity()*sizeof(size_t);
+                };
+
+        private:
+                inline size_t find_slot(NodeID key) {
+                        size_t pos = hash(key) & m_mask;
+                        while( m_keys[pos] != UNDEFINED_NODE && m_keys[pos] != key ) {
+                                pos = (pos + 1) & m_mask;
+                        }
+                        return pos;
+                };
+
+                inline size_t hash(NodeID key) const {
+                        return (size_t)key * 0x9E3779B97F4A7C15ull >> 17;
+                };
+
+                void resize(size_t capacity) {
+                        m_keys.assign(capacity, UNDEFINED_NODE);
+                        m_values.assign(capacity, 0);
+                        m_touched.clear();
+                        m_mask = capacity - 1;
+                };
+
+                std::vector<NodeID>     m_keys;
+                std::vector<EdgeWeight> m_values;
+                std::vector<size_t>     m_touched;
+                size_t                  m_mask;
+};
+
+#endif /* end of include guard: RATING_MAP_Q2M8TZ0L */
@@ -192,6 +192,11 @@ typedef enum {
         PRE_CONFIG_MAPPING_STRONG
 } PreConfigMapping;
 
+typedef enum {
+        CLUSTERING_ENGINE_MULTILEVEL,
+        CLUSTERING_ENGINE_PIVOT
+} ClusteringEngine;
+
 typedef enum {
         ANALYZER_MODE_MERGE,
         ANALYZER_MODE_AVERAGE,
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "data_structure/compressed_graph.h"
+#include "data_structure/graph_access.h"
+#include "mmap_graph_io.h"
+#include "partition_config.h"
+
+namespace kahip {
+    namespace mmap_io {
+        // Builds the compressed graph straight from a METIS file, the plain adjacency arrays are never
+        // allocated. The line of every node is located once, the compression parses the line of a node
+        // whenever it needs the neighborhood.
+        inline void compressed_graph_from_metis_file(compressed_graph &CG, const std::string &filename,
+                                                     bool sign_split, int num_threads) {
+            num_threads = std::max(1, num_threads);
+            const MetisChunks metis = count_metis_file(filename, num_threads);
+            const NodeID n = metis.header.number_of_nodes;
+
+            std::vector<const char *> line_begin(n);
+            bool unit_weights = true;
+
+            #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1) reduction(&&:unit_weights)
+            for (std::size_t c = 0; c < metis.chunks.size(); ++c) {
+                for_each_node_line(metis, c, [&](NodeID node, const char *p, const char *line_end) {
+                    line_begin[node] = p;
+                    if (metis.header.has_edge_weights && unit_weights) {
+                        parse_node_line(metis, p, line_end, [&](NodeID, EdgeWeight weight) {
+                            unit_weights = unit_weights && (weight == 1 || weight == -1);
+                        });
+                    }
+                });
+            }
+
+            const char *data_end = metis.mapped_file.contents + metis.mapped_file.length;
+            auto source = [&](NodeID node, std::vector<Edge> &edges) {
+                const char *p = line_begin[node];
+                return parse_node_line(metis, p, find_line_end(p, data_end), [&](NodeID target, EdgeWeight weight) {
+                    Edge edge;
+                    edge.target = target;
+                    edge.weight = weight;
+                    edges.push_back(edge);
+                });
+            };
+            CG.build(n, 2 * metis.header.number_of_edges, sign_split, unit_weights, num_threads, source);
+
+            munmap_file_from_disk(metis.mapped_file);
+        }
+
+        // Reads the compressed graph without a plain copy of a METIS file (use_mmap_io does not matter).
+        // Binary graph files are mapped and compressed, every rank keeps its own compressed graph.
+        inline void read_compressed_graph(compressed_graph &CG, const std::string &filename, const PartitionConfig &config) {
+            if (is_binary_graph_file(filename)) {
+                graph_access G;
+                graph_from_binary_file(G, filename);
+                CG.build(G, config.sign_split_adjacency, config.n_threads);
+                G.release_memory();
+            } else {
+                compressed_graph_from_metis_file(CG, filename, config.sign_split_adjacency, config.n_threads);
+            }
+        }
+    } // namespace mmap_io
+} // namespace kahip
@@ -9,7 +9,10 @@
 #include <map>
 #include <unordered_map>
 #include <set>
+#include <algorithm>
+#include <omp.h>
 #include "graph_io.h"
+#include "mmap_graph_io.h"
 
 graph_io::graph_io() {
 
@@ -44,10 +47,12 @@ int graph_io::readGraphWeighted(graph_access & G, const std::string & filename)
         ss >> nmbEdges;
         ss >> ew;
 
+#ifndef MODE64BITEDGES
         if( 2*nmbEdges > std::numeric_limits<int>::max() || nmbNodes > std::numeric_limits<int>::max()) {
-                std::cerr <<  "The graph is too large. Currently only 32bit supported!"  << std::endl;
+                std::cerr <<  "The graph is too large. Please build with -D64BITMODE=On for 64 bit support."  << std::endl;
                 exit(0);
         }
+#endif
 
         bool read_ew = false;
         bool read_nw = false;
@@ -74,6 +79,11 @@ int graph_io::readGraphWeighted(graph_access & G, const std::string & filename)
                         continue;
                 }
 
+                // blank lines after the last node
+                if (node_counter == (NodeID) nmbNodes && line.find_first_not_of(" \t\r") == std::string::npos) {
+                        continue;
+                }
+
                 NodeID node = G.new_node(); node_counter++;
                 G.setPartitionIndex(node, 0);
 
@@ -139,15 +149,13 @@ int graph_io::writeMap(std::vector<NodeID> &map_real_virtual, const std::string
         return 0;
 }
 
-int graph_io::readWeightedEdgeStreamToGraph(graph_access & G, const std::string & filename, std::vector<NodeID> &map_real_virtual, bool relabel_nodes) {
-        std::string line;
-        long nmbNodes;
-        long nmbEdges;
-	NodeID i, x, y;
-	EdgeWeight ew;
-	EdgeID num_edges = 0;
-	NodeID num_nodes = 0;
-	NodeID real_x, real_y;
+// Arcs are parsed in parallel from the mapped file, bucket sorted by their source (one counting pass,
+// one filling pass, every arc is inserted in both directions) and then every bucket is sorted by
+// target on its own, which merges parallel arcs. Apart from the final graph this needs the arc list
+// and one Edge per direction of every arc.
+int graph_io::readWeightedEdgeStreamToGraph(graph_access & G, const std::string & filename, std::vector<NodeID> &map_real_virtual, bool relabel_nodes, int num_threads) {
+        using namespace kahip::mmap_io;
+        num_threads = std::max(1, num_threads);
 
         // open file for reading
         std::ifstream in(filename.c_str());
@@ -155,94 +163,197 @@ int graph_io::readWeightedEdgeStreamToGraph(graph_access & G, const std::string
                 std::cerr << "Error opening " << filename << std::endl;
                 return 1;
         }
+        in.close();
+
+        MappedFile mapped_file = mmap_file_from_disk(filename);
+        const char * p   = mapped_file.contents;
+        const char * end = mapped_file.contents + mapped_file.length;
 
-        std::getline(in,line);
         //skip comments
-        while( line[0] == '%' || line[0] == '#' ) {
-                std::getline(in, line);
+        const char * line_end = find_line_end(p, end);
+        while( p < end && (*p == '%' || *p == '#') ) {
+                p        = line_end + 1;
+                line_end = find_line_end(p, end);
+        }
+        if( p >= end ) {
+                std::cerr <<  "The edge list does not contain a header line."  << std::endl;
+                exit(0);
         }
 
-        std::stringstream ss(line);
-        ss >> nmbNodes;
-        ss >> nmbEdges;
+        p = skip_blanks(p, line_end);
+        std::int64_t number;
+        if( !scan_int(p, line_end, number) ) parse_error(mapped_file.contents, p);
+        long nmbNodes = number;
+        const char * data_begin = std::min(end, line_end + 1);
+
+        // pass 1: number of arcs per chunk
+        std::vector<Chunk> chunks = split_into_chunks(data_begin, end, num_threads);
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1)
+        for( size_t c = 0; c < chunks.size(); c++) {
+                for( const char * q = chunks[c].begin; q < chunks[c].end; ) {
+                        const char * arc_end = find_line_end(q, chunks[c].end);
+                        const char * first   = skip_blanks(q, arc_end);
+                        if( first < arc_end && *first != '%' && *first != '#' ) {
+                                chunks[c].number_of_edges++;
+                        }
+                        q = arc_end + 1;
+                }
+        }
 
-	std::unordered_map<NodeID,NodeID> map_virtual_real;
-	map_real_virtual.clear();
+        std::vector<uint64_t> first_arc(chunks.size() + 1, 0);
+        for( size_t c = 0; c < chunks.size(); c++) {
+                first_arc[c+1] = first_arc[c] + chunks[c].number_of_edges;
+        }
+        const uint64_t nmbArcs = first_arc[chunks.size()];
+
+        // pass 2: the arcs themselves, ids as given in the file
+        std::vector<uint64_t> sources(nmbArcs);
+        std::vector<uint64_t> targets(nmbArcs);
+        std::vector<EdgeWeight> weights(nmbArcs);
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1)
+        for( size_t c = 0; c < chunks.size(); c++) {
+                uint64_t arc = first_arc[c];
+                for( const char * q = chunks[c].begin; q < chunks[c].end; ) {
+                        const char * arc_end = find_line_end(q, chunks[c].end);
+                        q = skip_blanks(q, arc_end);
+                        if( q < arc_end && *q != '%' && *q != '#' ) {
+                                std::int64_t number;
+                                if( !scan_int(q, arc_end, number) ) parse_error(mapped_file.contents, q);
+                                sources[arc] = number; q = skip_blanks(q, arc_end);
+                                if( !scan_int(q, arc_end, number) ) parse_error(mapped_file.contents, q);
+                                targets[arc] = number; q = skip_blanks(q, arc_end);
+                                weights[arc] = 1;
+                                if( q < arc_end ) {
+                                        if( !scan_int(q, arc_end, number) ) parse_error(mapped_file.contents, q);
+                                        weights[arc] = number;
+                                }
+                                arc++;
+                        }
+                        q = arc_end + 1;
+                }
+        }
+        munmap_file_from_disk(mapped_file);
+
+        // relabel the nodes in the order of their first appearance, self-loops are ignored
+        map_real_virtual.clear();
+        if (relabel_nodes) {
+                uint64_t max_id = 0;
+                #pragma omp parallel for num_threads(num_threads) reduction(max:max_id)
+                for( uint64_t arc = 0; arc < nmbArcs; arc++) {
+                        max_id = std::max(max_id, std::max(sources[arc], targets[arc]));
+                }
 
-	std::vector<std::unordered_map<NodeID,EdgeWeight>> neighbors;
-	neighbors.resize(nmbNodes);
-        while(  std::getline(in, line)) {
-                if (line[0] == '%' || line[0] == '#' ) {
-                        continue;
+                // a direct lookup table unless the ids are spread too widely
+                bool dense = nmbArcs > 0 && max_id < 4*(uint64_t)nmbNodes + 1024;
+                std::vector<NodeID> dense_map(dense ? max_id + 1 : 0, UNDEFINED_NODE);
+                std::unordered_map<uint64_t, NodeID> sparse_map;
+                if (!dense) sparse_map.reserve(nmbNodes);
+
+                auto relabel = [&](uint64_t id) {
+                        NodeID & real = dense ? dense_map[id] : sparse_map.emplace(id, UNDEFINED_NODE).first->second;
+                        if (real == UNDEFINED_NODE) {
+                                if ((long)map_real_virtual.size() >= nmbNodes) {
+                                        std::cerr <<  "The edge list contains more nodes than specified."  << std::endl;
+                                        exit(0);
+                                }
+                                real = map_real_virtual.size();
+                                map_real_virtual.push_back(id);
+                        }
+                        return (uint64_t)real;
+                };
+
+                for( uint64_t arc = 0; arc < nmbArcs; arc++) {
+                        if (sources[arc] == targets[arc]) continue;
+                        sources[arc] = relabel(sources[arc]);
+                        targets[arc] = relabel(targets[arc]);
                 }
-		std::stringstream ss(line);
-		ss >> x;
-		ss >> y;
-		ss >> ew;
-
-		if (x == y) {
-			continue;
-		}
-
-		if (relabel_nodes) {
-			if (map_virtual_real.find(x) == map_virtual_real.end()) {
-				map_virtual_real[x] = num_nodes++;
-				map_real_virtual.push_back(x);
-			}
-			if (map_virtual_real.find(y) == map_virtual_real.end()) {
-				map_virtual_real[y] = num_nodes++;
-				map_real_virtual.push_back(y);
-			}
-			real_x = map_virtual_real[x];
-			real_y = map_virtual_real[y];
-		} else {
-			real_x = x;
-			real_y = y;
-			if (real_x >= nmbNodes || real_y >= nmbNodes) {
-				std::cerr <<  "Nodes need to be relabeled for this input."  << std::endl;
-				exit(0);
-			}
-		}	
-
-		// Substitute arcs and parallel edges by a single undirected edge whose weight equals the sum of arc weights
-		if (neighbors[real_x].find(real_y) == neighbors[real_x].end() || neighbors[real_x][real_y] == 0) {
-			neighbors[real_x][real_y] = ew;
-			num_edges++;
-		} else {
-			neighbors[real_x][real_y] += ew;
-			if (neighbors[real_x][real_y] == 0) num_edges--;
-		}
-
-		if (neighbors[real_y].find(real_x) == neighbors[real_y].end() || neighbors[real_y][real_x] == 0) {
-			neighbors[real_y][real_x] = ew;
-			num_edges++;
-		} else {
-			neighbors[real_y][real_x] += ew;
-			if (neighbors[real_y][real_x] == 0) num_edges--;
-		}
-	}
+        } else {
+                for( uint64_t arc = 0; arc < nmbArcs; arc++) {
+                        if (sources[arc] == targets[arc]) continue;
+                        if (sources[arc] >= (uint64_t)nmbNodes || targets[arc] >= (uint64_t)nmbNodes) {
+                                std::cerr <<  "Nodes need to be relabeled for this input."  << std::endl;
+                                exit(0);
+                        }
+                }
+        }
+
+        // bucket sort both directions of every arc by source
+        std::vector<EdgeID> bucket_begin(nmbNodes + 1, 0);
+        #pragma omp parallel for num_threads(num_threads) schedule(static)
+        for( uint64_t arc = 0; arc < nmbArcs; arc++) {
+                if (sources[arc] == targets[arc]) continue;
+                __atomic_fetch_add(&bucket_begin[sources[arc]], 1, __ATOMIC_RELAXED);
+                __atomic_fetch_add(&bucket_begin[targets[arc]], 1, __ATOMIC_RELAXED);
+        }
+        EdgeID sum = 0;
+        for( long node = 0; node <= nmbNodes; node++) {
+                EdgeID degree      = bucket_begin[node];
+                bucket_begin[node] = sum;
+                sum               += degree;
+        }
+
+        std::vector<EdgeID> insert_pos(bucket_begin.begin(), bucket_begin.end());
+        std::vector<Edge> buckets(sum);
+        #pragma omp parallel for num_threads(num_threads) schedule(static)
+        for( uint64_t arc = 0; arc < nmbArcs; arc++) {
+                if (sources[arc] == targets[arc]) continue;
+                EdgeID pos = __atomic_fetch_add(&insert_pos[sources[arc]], 1, __ATOMIC_RELAXED);
+                buckets[pos].target = targets[arc];
+                buckets[pos].weight = weights[arc];
+                pos = __atomic_fetch_add(&insert_pos[targets[arc]], 1, __ATOMIC_RELAXED);
+                buckets[pos].target = sources[arc];
+                buckets[pos].weight = weights[arc];
+        }
+        std::vector<uint64_t>().swap(sources);
+        std::vector<uint64_t>().swap(targets);
+        std::vector<EdgeWeight>().swap(weights);
+        std::vector<EdgeID>().swap(insert_pos);
+
+        // substitute arcs and parallel edges by a single undirected edge whose weight equals the sum of arc weights,
+        // edges whose weights cancel out are dropped. degree[node] is the merged degree afterwards
+        std::vector<EdgeID> degree(nmbNodes + 1, 0);
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1024)
+        for( long node = 0; node < nmbNodes; node++) {
+                Edge * first = buckets.data() + bucket_begin[node];
+                Edge * last  = buckets.data() + bucket_begin[node+1];
+                std::sort(first, last, [](const Edge & a, const Edge & b) { return a.target < b.target; });
+
+                Edge * out = first;
+                for( Edge * cur = first; cur < last; ) {
+                        Edge merged = *cur;
+                        for( ++cur; cur < last && cur->target == merged.target; ++cur) {
+                                merged.weight += cur->weight;
+                        }
+                        if (merged.weight != 0) *out++ = merged;
+                }
+                degree[node] = out - first;
+        }
 
-	nmbEdges = num_edges;
-        if( nmbEdges > std::numeric_limits<int>::max() || nmbNodes > std::numeric_limits<int>::max() ) {
-                std::cerr <<  "The graph is too large. Currently only 32bit supported!"  << std::endl;
+        EdgeID nmbEdges = 0;
+        for( long node = 0; node <= nmbNodes; node++) {
+                EdgeID d     = degree[node];
+                degree[node] = nmbEdges;
+                nmbEdges    += d;
+        }
+#ifndef MODE64BITEDGES
+        if( nmbEdges > (EdgeID) std::numeric_limits<int>::max() || nmbNodes > std::numeric_limits<int>::max() ) {
+                std::cerr <<  "The graph is too large. Please build with -D64BITMODE=On for 64 bit support."  << std::endl;
                 exit(0);
         }
-	
-	G.start_construction(nmbNodes, nmbEdges);
-	for( i = 0 ; i < nmbNodes ; i++) {
-                NodeID node = G.new_node(); 
+#endif
+
+        G.start_bulk_construction(nmbNodes, nmbEdges);
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1024)
+        for( long node = 0; node < nmbNodes; node++) {
+                G.set_first_edge(node, degree[node]);
+                G.setNodeWeight(node, 1);
                 G.setPartitionIndex(node, 0);
-                NodeWeight weight = 1;
-                G.setNodeWeight(node, weight);
-		for (auto& it : neighbors[node]) {
-			NodeID target = it.first;
-                        EdgeWeight edge_weight = it.second;
-			if (edge_weight == 0) continue;
-                        EdgeID e = G.new_edge(node, target);
-                        G.setEdgeWeight(e, edge_weight);
+                for( EdgeID i = 0; i < degree[node+1] - degree[node]; i++) {
+                        const Edge & edge = buckets[bucket_begin[node] + i];
+                        G.set_edge(degree[node] + i, edge.target, edge.weight);
                 }
         }
-        G.finish_construction();
+        G.finish_bulk_construction();
 	return 0;
 }
 
@@ -299,52 +410,6 @@ int graph_io::writeRandomSignedGraphWeighted(graph_access & G, const std::string
         return 0;
 }
 
-int graph_io::readPartition(graph_access & G, const std::string & filename) {
-        std::string line;
-
-        // open file for reading
-        std::ifstream in(filename.c_str());
-        if (!in) {
-                std::cerr << "Error opening file" << filename << std::endl;
-                return 1;
-        }
-
-        PartitionID max = 0;
-        forall_nodes(G, node) {
-                                // fetch current line
-                                std::getline(in, line);
-                                if (line[0] == '%') { //Comment
-                                        node--;
-                                        continue;
-                                }
-
-                                // in this line we find the block of Node node
-                                G.setPartitionIndex(node, (PartitionID) atol(line.c_str()));
-
-                                if(G.getPartitionIndex(node) > max)
-                                        max = G.getPartitionIndex(node);
-                        } endfor
-
-        G.set_partition_count(max+1);
-        in.close();
-
-        return 0;
-}
-
-void graph_io::writePartition(graph_access & G, const std::string & filename) {
-        std::ofstream f(filename.c_str());
-        std::cout << "writing partition to " << filename << " ... " << std::endl;
-
-        forall_nodes(G, node) {
-                f << G.getPartitionIndex(node) <<  "\n";
-        } endfor
-
-        f.close();
-}
-
-
-
-
 int graph_io::readLogFile(LogVector & input_log, const std::string & filename) {
         std::string line;
 	double timestamp;
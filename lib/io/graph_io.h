@@ -80,7 +80,7 @@ class graph_io {
 		int writeMap(std::vector<NodeID> &map_real_virtual, const std::string & filename);
 
                 static
-		int readWeightedEdgeStreamToGraph(graph_access & G, const std::string & filename, std::vector<NodeID> &map_real_virtual, bool relabel_nodes);
+		int readWeightedEdgeStreamToGraph(graph_access & G, const std::string & filename, std::vector<NodeID> &map_real_virtual, bool relabel_nodes, int num_threads = 1);
 
                 static
                 int readGraphWeighted(graph_access & G, const std::string & filename);
@@ -94,11 +94,12 @@ class graph_io {
                 static
                 int writeGraph(graph_access & G, const std::string & filename);
 
-                static
-                int readPartition(graph_access& G, const std::string & filename);
+                // Graph is graph_access or compressed_graph
+                template<typename Graph>
+                static int readPartition(Graph& G, const std::string & filename);
 
-                static
-                void writePartition(graph_access& G, const std::string & filename);
+                template<typename Graph>
+                static void writePartition(Graph& G, const std::string & filename);
 
                 template<typename vectortype>
                 static void writeVector(std::vector<vectortype> & vec, const std::string & filename);
@@ -116,6 +117,51 @@ class graph_io {
 		///////// Methods for processing logs
 };
 
+template<typename Graph>
+int graph_io::readPartition(Graph & G, const std::string & filename) {
+        std::string line;
+
+        // open file for reading
+        std::ifstream in(filename.c_str());
+        if (!in) {
+                std::cerr << "Error opening file" << filename << std::endl;
+                return 1;
+        }
+
+        PartitionID max = 0;
+        forall_nodes(G, node) {
+                                // fetch current line
+                                std::getline(in, line);
+                                if (line[0] == '%') { //Comment
+                                        node--;
+                                        continue;
+                                }
+
+                                // in this line we find the block of Node node
+                                G.setPartitionIndex(node, (PartitionID) atol(line.c_str()));
+
+                                if(G.getPartitionIndex(node) > max)
+                                        max = G.getPartitionIndex(node);
+                        } endfor
+
+        G.set_partition_count(max+1);
+        in.close();
+
+        return 0;
+}
+
+template<typename Graph>
+void graph_io::writePartition(Graph & G, const std::string & filename) {
+        std::ofstream f(filename.c_str());
+        std::cout << "writing partition to " << filename << " ... " << std::endl;
+
+        forall_nodes(G, node) {
+                f << G.getPartitionIndex(node) <<  "\n";
+        } endfor
+
+        f.close();
+}
+
 template<typename vectortype>
 void graph_io::writeVector(std::vector<vectortype> & vec, const std::string & filename) {
         std::ofstream f(filename.c_str());
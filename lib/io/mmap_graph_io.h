@@ -1,30 +1,47 @@
 #pragma once
 
+#include <algorithm>
 #include <cctype>
 #include <cstring>
 #include <fcntl.h>
 #include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <omp.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <vector>
+
+#include "data_structure/graph_access.h"
 
 namespace kahip {
     namespace mmap_io {
-        namespace {
-            struct MappedFile {
-                const int fd;
-                std::size_t position;
-                const std::size_t length;
-                char *contents;
+        struct MappedFile {
+            const int fd;
+            std::size_t position;
+            const std::size_t length;
+            char *contents;
 
-                inline bool valid_position() const { return position < length; }
+            inline bool valid_position() const { return position < length; }
 
-                inline char current() const { return contents[position]; }
+            inline char current() const { return contents[position]; }
 
-                inline void advance() { ++position; }
-            };
+            inline void advance() { ++position; }
+        };
+
+        // a range of whole lines of a METIS file, [begin, end)
+        struct Chunk {
+            const char *begin;
+            const char *end;
+            std::uint64_t number_of_nodes;
+            std::uint64_t number_of_edges;
+            std::uint64_t trailing_blank_lines; // blank node lines after the last nonblank one
+        };
 
-            int open_file(const std::string &filename) {
+        namespace {
+            inline int open_file(const std::string &filename) {
                 int fd = open(filename.c_str(), O_RDONLY);
                 if (fd < 0) {
                     std::cerr << "Error while opening " << filename;
@@ -33,7 +50,7 @@ namespace kahip {
                 return fd;
             }
 
-            std::size_t file_size(const int fd) {
+            inline std::size_t file_size(const int fd) {
                 struct stat file_info{};
                 if (fstat(fd, &file_info) == -1) {
                     close(fd);
@@ -43,16 +60,19 @@ namespace kahip {
                 return static_cast<std::size_t>(file_info.st_size);
             }
 
-            MappedFile mmap_file_from_disk(const std::string &filename) {
+            // writable mappings are private, writes never reach the file
+            inline MappedFile mmap_file_from_disk(const std::string &filename, bool writable = false) {
                 const int fd = open_file(filename);
                 const std::size_t length = file_size(fd);
 
-                char *contents = static_cast<char *>(mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0));
+                const int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+                char *contents = static_cast<char *>(mmap(nullptr, length, protection, MAP_PRIVATE, fd, 0));
                 if (contents == MAP_FAILED) {
                     close(fd);
                     std::cerr << "Error while mapping file to memory";
                     std::exit(-1);
                 }
+                madvise(contents, length, writable ? MADV_WILLNEED : MADV_SEQUENTIAL);
 
                 return {
                         .fd = fd,
@@ -62,7 +82,7 @@ namespace kahip {
                 };
             }
 
-            void munmap_file_from_disk(const MappedFile &mapped_file) {
+            inline void munmap_file_from_disk(const MappedFile &mapped_file) {
                 if (munmap(mapped_file.contents, mapped_file.length) == -1) {
                     close(mapped_file.fd);
                     std::cerr << "Error while unmapping file from memory";
@@ -98,6 +118,80 @@ namespace kahip {
                 skip_spaces(mapped_file);
                 return number;
             }
+
+            // pointer based helpers for the parallel parser, a chunk is the range [p, end)
+            inline bool is_blank(const char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+            inline const char *skip_blanks(const char *p, const char *end) {
+                while (p < end && is_blank(*p)) ++p;
+                return p;
+            }
+
+            inline const char *find_line_end(const char *p, const char *end) {
+                const char *nl = static_cast<const char *>(std::memchr(p, '\n', end - p));
+                return nl == nullptr ? end : nl;
+            }
+
+            // reports a malformed token at p, the line number is counted from the begin of the file
+            [[noreturn]] inline void parse_error(const char *contents, const char *p) {
+                const std::size_t line = std::count(contents, p, '\n') + 1;
+                std::cerr << "parse error in line " << line << ": expected an integer" << std::endl;
+                std::exit(-1);
+            }
+
+            // signed, since edge weights of signed graphs are negative. returns false if p does not
+            // point to an integer that ends at a blank or at the end of the line
+            inline bool scan_int(const char *&p, const char *end, std::int64_t &number) {
+                bool negative = false;
+                if (p < end && *p == '-') {
+                    negative = true;
+                    ++p;
+                }
+                const char *digits = p;
+                number = 0;
+                while (p < end && *p >= '0' && *p <= '9') {
+                    number = number * 10 + (*p - '0');
+                    ++p;
+                }
+                if (negative) number = -number;
+                return p != digits && (p == end || is_blank(*p));
+            }
+
+            inline bool is_blank_line(const char *p, const char *end) { return skip_blanks(p, end) == end; }
+
+            inline std::size_t count_tokens(const char *p, const char *end) {
+                std::size_t tokens = 0;
+                p = skip_blanks(p, end);
+                while (p < end) {
+                    ++tokens;
+                    while (p < end && !is_blank(*p)) ++p;
+                    p = skip_blanks(p, end);
+                }
+                return tokens;
+            }
+
+            // splits [data_begin, data_end) into chunks of whole lines, a few per thread
+            inline std::vector<Chunk> split_into_chunks(const char *data_begin, const char *data_end, int num_threads) {
+                const std::size_t data_length = data_end - data_begin;
+                const std::size_t min_chunk_length = 1 << 20;
+                const std::size_t no_of_chunks = std::max<std::size_t>(1, std::min<std::size_t>(16 * num_threads,
+                                                                                                 data_length / min_chunk_length));
+
+                std::vector<Chunk> chunks(no_of_chunks, Chunk());
+                for (std::size_t c = 0; c < no_of_chunks; ++c) {
+                    const char *begin = data_begin + c * (data_length / no_of_chunks);
+                    if (c > 0) {
+                        // the chunk starts after the line that contains its nominal begin
+                        begin = std::min(data_end, find_line_end(begin - 1, data_end) + 1);
+                        begin = std::max(begin, chunks[c - 1].begin);
+                    }
+                    chunks[c].begin = begin;
+                }
+                for (std::size_t c = 0; c < no_of_chunks; ++c) {
+                    chunks[c].end = c + 1 < no_of_chunks ? chunks[c + 1].begin : data_end;
+                }
+                return chunks;
+            }
         } // namespace
 
         struct GraphHeader {
@@ -107,7 +201,7 @@ namespace kahip {
             bool has_edge_weights;
         };
 
-        GraphHeader read_graph_header(MappedFile &mapped_file) {
+        inline GraphHeader read_graph_header(MappedFile &mapped_file) {
             skip_spaces(mapped_file);
             while (mapped_file.current() == '%') {
                 skip_comment(mapped_file);
@@ -118,7 +212,7 @@ namespace kahip {
             const std::uint64_t number_of_edges = scan_uint(mapped_file);
             const std::uint64_t format =
                     (mapped_file.current() != '\n') ? scan_uint(mapped_file) : 0;
-            skip_nl(mapped_file);
+            skip_comment(mapped_file); // rest of the header line
 
             const bool has_node_weights = (format % 100) / 10; // == x1x
             const bool has_edge_weights = format % 10;         // == xx1
@@ -131,33 +225,279 @@ namespace kahip {
             };
         }
 
-        void graph_from_metis_file(graph_access &G, const std::string &filename) {
+        // The body of a METIS file split into chunks of whole lines, with the first node and the first edge
+        // of every chunk. The file stays mapped until it is unmapped by the caller.
+        struct MetisChunks {
+            MappedFile mapped_file;
+            GraphHeader header;
+            std::vector<Chunk> chunks;
+            std::vector<std::uint64_t> first_node;
+            std::vector<std::uint64_t> first_edge;
+        };
+
+        // Maps a METIS file and counts its nodes and edges in parallel: the mapped file is split into chunks
+        // at line boundaries, the nodes and edges of every chunk are counted, and prefix sums over these
+        // counts give the first node and the first edge of every chunk.
+        inline MetisChunks count_metis_file(const std::string &filename, int num_threads) {
             MappedFile mapped_file = mmap_file_from_disk(filename);
             const GraphHeader header = read_graph_header(mapped_file);
-            G.start_construction(header.number_of_nodes, 2 * header.number_of_edges);
 
-            for (NodeID u = 0; u < header.number_of_nodes; ++u) {
-                G.new_node();
-                G.setPartitionIndex(u, 0);
+#ifndef MODE64BITEDGES
+            if (2 * header.number_of_edges > (uint64_t) std::numeric_limits<int>::max() ||
+                header.number_of_nodes > (uint64_t) std::numeric_limits<int>::max()) {
+                std::cerr << "The graph is too large. Please build with -D64BITMODE=On for 64 bit support." << std::endl;
+                std::exit(-1);
+            }
+#endif
 
-                skip_spaces(mapped_file);
-                while (mapped_file.current() == '%') {
-                    skip_comment(mapped_file);
-                    skip_spaces(mapped_file);
+            const char *data_begin = mapped_file.contents + mapped_file.position;
+            const char *data_end = mapped_file.contents + mapped_file.length;
+
+            std::vector<Chunk> chunks = split_into_chunks(data_begin, data_end, num_threads);
+            const std::size_t no_of_chunks = chunks.size();
+
+            const std::size_t tokens_per_edge = header.has_edge_weights ? 2 : 1;
+            const std::size_t node_weight_tokens = header.has_node_weights ? 1 : 0;
+
+            #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1)
+            for (std::size_t c = 0; c < no_of_chunks; ++c) {
+                Chunk &chunk = chunks[c];
+                chunk.number_of_nodes = 0;
+                chunk.number_of_edges = 0;
+                chunk.trailing_blank_lines = 0;
+
+                const char *p = chunk.begin;
+                while (p < chunk.end) {
+                    const char *line_end = find_line_end(p, chunk.end);
+                    if (*p != '%') {
+                        std::size_t tokens = count_tokens(p, line_end);
+                        chunk.number_of_nodes++;
+                        chunk.number_of_edges += (tokens - std::min(tokens, node_weight_tokens)) / tokens_per_edge;
+                        chunk.trailing_blank_lines = tokens == 0 ? chunk.trailing_blank_lines + 1 : 0;
+                    }
+                    p = line_end + 1;
                 }
+            }
+
+            std::vector<std::uint64_t> first_node(no_of_chunks + 1, 0);
+            std::vector<std::uint64_t> first_edge(no_of_chunks + 1, 0);
+            for (std::size_t c = 0; c < no_of_chunks; ++c) {
+                first_node[c + 1] = first_node[c] + chunks[c].number_of_nodes;
+                first_edge[c + 1] = first_edge[c] + chunks[c].number_of_edges;
+            }
+
+            // blank lines at the end of the file are only nodes (without edges) as long as the header
+            // specifies more nodes, further ones are ignored like by graph_io::readGraphWeighted
+            std::uint64_t trailing_blank_lines = 0;
+            for (std::size_t c = no_of_chunks; c > 0; --c) {
+                trailing_blank_lines += chunks[c - 1].trailing_blank_lines;
+                if (chunks[c - 1].trailing_blank_lines != chunks[c - 1].number_of_nodes) break;
+            }
+            const std::uint64_t parsed_nodes = first_node[no_of_chunks];
+            if (parsed_nodes > header.number_of_nodes && parsed_nodes - header.number_of_nodes <= trailing_blank_lines) {
+                first_node[no_of_chunks] = header.number_of_nodes;
+            }
+
+            if (first_node[no_of_chunks] != header.number_of_nodes) {
+                std::cerr << "number of specified nodes mismatch" << std::endl;
+                std::cerr << first_node[no_of_chunks] << " " << header.number_of_nodes << std::endl;
+                std::exit(-1);
+            }
+            if (first_edge[no_of_chunks] != 2 * header.number_of_edges) {
+                std::cerr << "number of specified edges mismatch" << std::endl;
+                std::cerr << first_edge[no_of_chunks] << " " << 2 * header.number_of_edges << std::endl;
+                std::exit(-1);
+            }
+
+            return {
+                    .mapped_file = mapped_file,
+                    .header = header,
+                    .chunks = std::move(chunks),
+                    .first_node = std::move(first_node),
+                    .first_edge = std::move(first_edge),
+            };
+        }
 
-                G.setNodeWeight(u, header.has_node_weights ? scan_uint(mapped_file) : 1);
-                while (std::isdigit(mapped_file.current())) {
-                    const EdgeWeight weight = (header.has_edge_weights) ? scan_uint(mapped_file) : 1;
-                    const EdgeID e = G.new_edge(u, scan_uint(mapped_file) - 1);
-                    G.setEdgeWeight(e, weight);
+        // calls f(node, line_begin, line_end) for the line of every node of chunk c
+        template <typename NodeLineFunction>
+        inline void for_each_node_line(const MetisChunks &metis, std::size_t c, NodeLineFunction f) {
+            NodeID node = metis.first_node[c];
+            const char *p = metis.chunks[c].begin;
+            while (p < metis.chunks[c].end && node < metis.header.number_of_nodes) {
+                const char *line_end = find_line_end(p, metis.chunks[c].end);
+                if (*p != '%') {
+                    f(node, p, line_end);
+                    node++;
                 }
-                if (mapped_file.current() == '\n') {
-                    skip_nl(mapped_file);
+                p = line_end + 1;
+            }
+        }
+
+        // parses the line [p, line_end) of a node, calls add_edge(target, weight) for each of its edges and
+        // returns its weight
+        template <typename AddEdgeFunction>
+        inline NodeWeight parse_node_line(const MetisChunks &metis, const char *p, const char *line_end,
+                                          AddEdgeFunction add_edge) {
+            const char *contents = metis.mapped_file.contents;
+            p = skip_blanks(p, line_end);
+            std::int64_t number;
+            NodeWeight node_weight = 1;
+            if (metis.header.has_node_weights && p < line_end) {
+                if (!scan_int(p, line_end, number)) parse_error(contents, p);
+                node_weight = number;
+                p = skip_blanks(p, line_end);
+            }
+
+            while (p < line_end) {
+                if (!scan_int(p, line_end, number)) parse_error(contents, p);
+                const NodeID target = number - 1;
+                p = skip_blanks(p, line_end);
+
+                EdgeWeight weight = 1;
+                if (metis.header.has_edge_weights) {
+                    if (!scan_int(p, line_end, number)) parse_error(contents, p);
+                    weight = number;
+                    p = skip_blanks(p, line_end);
                 }
+                add_edge(target, weight);
+            }
+            return node_weight;
+        }
+
+        // Parses the body of a METIS file in parallel, the second pass over the chunks writes the adjacency
+        // arrays of the graph directly.
+        inline void graph_from_metis_file(graph_access &G, const std::string &filename, int num_threads = 1) {
+            num_threads = std::max(1, num_threads);
+            const MetisChunks metis = count_metis_file(filename, num_threads);
+
+            G.start_bulk_construction(metis.header.number_of_nodes, 2 * metis.header.number_of_edges);
+
+            #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1)
+            for (std::size_t c = 0; c < metis.chunks.size(); ++c) {
+                EdgeID edge = metis.first_edge[c];
+                for_each_node_line(metis, c, [&](NodeID node, const char *p, const char *line_end) {
+                    G.set_first_edge(node, edge);
+                    G.setPartitionIndex(node, 0);
+                    G.setNodeWeight(node, parse_node_line(metis, p, line_end, [&](NodeID target, EdgeWeight weight) {
+                        G.set_edge(edge++, target, weight);
+                    }));
+                });
+            }
+
+            G.finish_bulk_construction();
+            munmap_file_from_disk(metis.mapped_file);
+        }
+
+        // Binary graph files store the node and the edge array of basicGraph as they are laid out in
+        // memory, so that they can be mapped into the graph without parsing or copying. The layout
+        // depends on the type widths of the build, a header records them.
+        const std::uint64_t BINARY_GRAPH_MAGIC   = 0x3130474953434353ull; // "SCCSIG01"
+        const std::uint64_t BINARY_GRAPH_VERSION = 1;
+        const std::uint64_t BINARY_GRAPH_ALIGN   = 4096;
+
+        struct BinaryGraphHeader {
+            std::uint64_t magic;
+            std::uint64_t version;
+            std::uint64_t node_bytes;
+            std::uint64_t edge_bytes;
+            std::uint64_t number_of_nodes;
+            std::uint64_t number_of_edges;
+            std::uint64_t nodes_offset; // n+1 Node entries, the last one is the sentinel
+            std::uint64_t edges_offset; // m Edge entries
+        };
+
+        inline bool is_binary_graph_file(const std::string &filename) {
+            std::ifstream in(filename.c_str(), std::ios::binary);
+            std::uint64_t magic = 0;
+            in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+            return in && magic == BINARY_GRAPH_MAGIC;
+        }
+
+        inline void graph_to_binary_file(graph_access &G, const std::string &filename) {
+            BinaryGraphHeader header{};
+            header.magic           = BINARY_GRAPH_MAGIC;
+            header.version         = BINARY_GRAPH_VERSION;
+            header.node_bytes      = sizeof(Node);
+            header.edge_bytes      = sizeof(Edge);
+            header.number_of_nodes = G.number_of_nodes();
+            header.number_of_edges = G.number_of_edges();
+            header.nodes_offset    = BINARY_GRAPH_ALIGN;
+            header.edges_offset    = header.nodes_offset + (header.number_of_nodes + 1) * sizeof(Node);
+            header.edges_offset    = (header.edges_offset + BINARY_GRAPH_ALIGN - 1) / BINARY_GRAPH_ALIGN * BINARY_GRAPH_ALIGN;
+
+            std::ofstream out(filename.c_str(), std::ios::binary);
+            if (!out) {
+                std::cerr << "Error while opening " << filename << std::endl;
+                std::exit(-1);
+            }
+
+            std::vector<char> padding(BINARY_GRAPH_ALIGN, 0);
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            out.write(padding.data(), header.nodes_offset - sizeof(header));
+
+            std::vector<Node> nodes(G.number_of_nodes() + 1, Node());
+            forall_nodes(G, node) {
+                nodes[node].firstEdge = G.get_first_edge(node);
+                nodes[node].weight    = G.getNodeWeight(node);
+            } endfor
+            nodes[G.number_of_nodes()].firstEdge = G.number_of_edges();
+            out.write(reinterpret_cast<const char *>(nodes.data()), nodes.size() * sizeof(Node));
+            out.write(padding.data(), header.edges_offset - header.nodes_offset - nodes.size() * sizeof(Node));
+
+            std::vector<Edge> edges(G.number_of_edges(), Edge());
+            forall_edges(G, e) {
+                edges[e].target = G.getEdgeTarget(e);
+                edges[e].weight = G.getEdgeWeight(e);
+            } endfor
+            out.write(reinterpret_cast<const char *>(edges.data()), edges.size() * sizeof(Edge));
+
+            if (!out) {
+                std::cerr << "Error while writing " << filename << std::endl;
+                std::exit(-1);
             }
-            G.finish_construction();
-            munmap_file_from_disk(mapped_file);
+        }
+
+        // Maps the file privately (copy on write), the graph refers to the mapped arrays. Processes that
+        // load the same file share its pages in the page cache as long as they do not modify the graph.
+        inline void graph_from_binary_file(graph_access &G, const std::string &filename) {
+            MappedFile mapped_file = mmap_file_from_disk(filename, true);
+
+            BinaryGraphHeader header{};
+            if (mapped_file.length < sizeof(header)) {
+                std::cerr << filename << " is not a binary graph file" << std::endl;
+                std::exit(-1);
+            }
+            std::memcpy(&header, mapped_file.contents, sizeof(header));
+
+            if (header.magic != BINARY_GRAPH_MAGIC || header.version != BINARY_GRAPH_VERSION) {
+                std::cerr << filename << " is not a binary graph file of version " << BINARY_GRAPH_VERSION << std::endl;
+                std::exit(-1);
+            }
+            if (header.node_bytes != sizeof(Node) || header.edge_bytes != sizeof(Edge)) {
+                std::cerr << filename << " was written by a build with different type widths (64BITMODE), "
+                          << "please convert the graph again." << std::endl;
+                std::exit(-1);
+            }
+            if (header.nodes_offset + (header.number_of_nodes + 1) * sizeof(Node) > mapped_file.length ||
+                header.edges_offset + header.number_of_edges * sizeof(Edge) > mapped_file.length) {
+                std::cerr << filename << " is truncated" << std::endl;
+                std::exit(-1);
+            }
+
+            // the descriptor is not needed anymore, the mapping stays valid until it is unmapped
+            close(mapped_file.fd);
+            char *contents = mapped_file.contents;
+            const std::size_t length = mapped_file.length;
+            std::shared_ptr<void> owner(contents, [length](void *addr) { munmap(addr, length); });
+
+            G.attach_external_graph(reinterpret_cast<Node *>(contents + header.nodes_offset),
+                                    header.number_of_nodes,
+                                    reinterpret_cast<Edge *>(contents + header.edges_offset),
+                                    header.number_of_edges,
+                                    owner);
+            forall_nodes(G, node) {
+                G.setPartitionIndex(node, 0);
+            } endfor
         }
     } // namespace mmap_io
 } // namespace kahip
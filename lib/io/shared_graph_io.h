@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mpi.h>
+#include <omp.h>
+#include <string>
+
+#include "data_structure/graph_access.h"
+#include "graph_io.h"
+#include "mmap_graph_io.h"
+#include "partition_config.h"
+
+namespace kahip {
+    namespace shared_io {
+        // reads the graph as selected by the file type and config.use_mmap_io
+        inline void read_graph(graph_access &G, const std::string &filename, const PartitionConfig &config) {
+            if (mmap_io::is_binary_graph_file(filename)) {
+                mmap_io::graph_from_binary_file(G, filename);
+            } else if (config.use_mmap_io) {
+                mmap_io::graph_from_metis_file(G, filename, config.n_threads);
+            } else {
+                graph_io::readGraphWeighted(G, filename);
+            }
+        }
+
+        // Reads the graph once per shared memory node instead of once per rank. The first rank of every node
+        // reads the graph and copies the node and edge arrays into a window of MPI_Win_allocate_shared, all
+        // ranks of the node attach to the window. The partition arrays stay private to every rank. If the
+        // sign split layout is used, the edges are split before they are shared, so the ranks only read them.
+        //
+        // Binary graph files are mapped by every rank (the page cache shares them already), as are graphs
+        // of ranks that are alone on their node. The window is freed collectively by G.release_memory(),
+        // which has to be called by all ranks of the node before MPI_Finalize.
+        inline void read_graph_node_shared(graph_access &G, const std::string &filename,
+                                           const PartitionConfig &config, MPI_Comm communicator) {
+            MPI_Comm node_communicator;
+            MPI_Comm_split_type(communicator, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_communicator);
+            int node_rank, node_size;
+            MPI_Comm_rank(node_communicator, &node_rank);
+            MPI_Comm_size(node_communicator, &node_size);
+
+            if (node_size == 1 || mmap_io::is_binary_graph_file(filename)) {
+                MPI_Comm_free(&node_communicator);
+                read_graph(G, filename, config);
+                return;
+            }
+
+            graph_access local_G;
+            std::uint64_t sizes[2] = {0, 0};
+            if (node_rank == 0) {
+                read_graph(local_G, filename, config);
+                if (config.sign_split_adjacency) {
+                    local_G.split_edges_by_sign(config.n_threads);
+                }
+                sizes[0] = local_G.number_of_nodes();
+                sizes[1] = local_G.number_of_edges();
+            }
+            MPI_Bcast(sizes, 2, MPI_UINT64_T, 0, node_communicator);
+            const NodeID n = sizes[0];
+            const EdgeID m = sizes[1];
+
+            const std::size_t node_bytes = (n + 1) * sizeof(Node);
+            const std::size_t bytes = node_bytes + m * sizeof(Edge);
+            char *base = NULL;
+            MPI_Win window;
+            MPI_Win_allocate_shared(node_rank == 0 ? bytes : 0, 1, MPI_INFO_NULL, node_communicator, &base, &window);
+            if (node_rank != 0) {
+                MPI_Aint size;
+                int disp_unit;
+                MPI_Win_shared_query(window, 0, &size, &disp_unit, &base);
+            }
+            Node *nodes = reinterpret_cast<Node *>(base);
+            Edge *edges = reinterpret_cast<Edge *>(base + node_bytes);
+
+            MPI_Win_lock_all(MPI_MODE_NOCHECK, window);
+            if (node_rank == 0) {
+                #pragma omp parallel for num_threads(std::max(1, config.n_threads)) schedule(dynamic, 1024)
+                for (NodeID node = 0; node <= n; node++) {
+                    nodes[node].firstEdge = node < n ? local_G.get_first_edge(node) : m;
+                    nodes[node].weight = node < n ? local_G.getNodeWeight(node) : 0;
+                    if (node == n) continue;
+                    forall_out_edges(local_G, e, node) {
+                        edges[e].target = local_G.getEdgeTarget(e);
+                        edges[e].weight = local_G.getEdgeWeight(e);
+                    } endfor
+                }
+                local_G.release_memory();
+            }
+            MPI_Win_sync(window);
+            MPI_Barrier(node_communicator);
+            MPI_Win_sync(window);
+            MPI_Win_unlock_all(window);
+
+            // the window and the communicator are freed together with the arrays of G
+            std::shared_ptr<void> owner(base, [window, node_communicator](void *) mutable {
+                MPI_Win_free(&window);
+                MPI_Comm_free(&node_communicator);
+            });
+            G.attach_external_graph(nodes, n, edges, m, owner);
+            forall_nodes(G, node) {
+                G.setPartitionIndex(node, 0);
+            } endfor
+            if (config.sign_split_adjacency) {
+                G.split_edges_by_sign(config.n_threads);
+            }
+        }
+    } // namespace shared_io
+} // namespace kahip
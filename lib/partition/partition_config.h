@@ -12,7 +12,11 @@
 
 #include "definitions.h"
 
+class clustering_statistics;
+class clustering_workspace;
+
 // Configuration for the partitioning.
+
 struct PartitionConfig
 {
         PartitionConfig() {}
@@ -208,6 +212,10 @@ struct PartitionConfig
 
         unsigned mh_pool_size;
 
+        unsigned mh_diversity_sketch_size; // 0: exact symmetric differences of the cut edges in population::insert
+
+        bool mh_diversity_verify;
+
         bool combine; // in this case the second index is filled and edges between both partitions are not contracted
 
         unsigned initial_partition_optimize_fm_limits;
@@ -370,6 +378,29 @@ struct PartitionConfig
         //============================================================
         bool gen_random_signed_graph;
         int n_threads;
+        bool parallel_label_propagation;
+        bool parallel_lp_refinement;
+        bool deterministic_tie_breaking;
+        bool deterministic;
+        int deterministic_sub_rounds;
+        bool parallel_kway_fm;
+        unsigned kway_fm_seeds_per_search;
+        int kway_fm_step_limit;
+        bool kway_gain_cache;
+        bool sign_split_adjacency;
+        std::string statistics_output;
+        clustering_statistics * statistics; // per level statistics, NULL if disabled
+        bool use_huge_pages;
+        bool use_compressed_graph;
+        ClusteringEngine clustering_engine;
+        bool pivot_lp_refinement;
+        bool pivot_initial_clustering;
+        bool kernelization;
+        bool cluster_merge_refinement;
+        int cluster_merge_rounds;
+        bool positive_component_decomposition;
+        NodeID positive_component_task_size;
+        clustering_workspace * workspace; // scratch memory of the current clustering run, NULL outside of a run
 	std::string filename_log;
         bool output_partition;
         bool elitism;
@@ -0,0 +1,111 @@
+/******************************************************************************
+ * clustering_statistics.cpp
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "clustering_statistics.h"
+
+level_statistics & clustering_statistics::select_level(unsigned level, NodeID nodes, EdgeID edges) {
+        // levels of a cycle are visited top down during coarsening and bottom up during uncoarsening
+        for( size_t i = m_levels.size(); i > 0; i--) {
+                level_statistics & record = m_levels[i-1];
+                if( record.run != m_run || record.cycle != m_cycle ) break;
+                if( record.level == level ) {
+                        m_current = &record;
+                        return record;
+                }
+        }
+
+        level_statistics record = level_statistics();
+        record.run   = m_run;
+        record.cycle = m_cycle;
+        record.level = level;
+        record.nodes = nodes;
+        record.edges = edges;
+        m_levels.push_back(record);
+
+        m_current = &m_levels.back();
+        return *m_current;
+}
+
+void clustering_statistics::write(const std::string & filename) const {
+        std::ofstream f(filename.c_str());
+        if (!f) {
+                std::cerr << "Error opening " << filename << std::endl;
+                return;
+        }
+
+        const std::string suffix = ".csv";
+        if( filename.size() >= suffix.size() && filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) == 0 ) {
+                write_csv(f);
+        } else {
+                write_json(f);
+        }
+}
+
+std::string clustering_statistics::filename_of_rank(const std::string & filename, int rank) {
+        size_t dot   = filename.find_last_of('.');
+        size_t slash = filename.find_last_of('/');
+        if( dot == std::string::npos || (slash != std::string::npos && dot < slash) ) {
+                dot = filename.size();
+        }
+
+        std::stringstream result;
+        result << filename.substr(0, dot) << "_" << rank << filename.substr(dot);
+        return result.str();
+}
+
+void clustering_statistics::write_csv(std::ostream & out) const {
+        out << "run,cycle,level,nodes,edges,"
+            << "lp_iterations,labels_changed,coarse_nodes,lp_time,contraction_time,"
+            << "lp_refinement_iterations,lp_refinement_moves,lp_refinement_time,cluster_merges,cluster_merge_time,"
+            << "kway_moves,kway_rollbacks,kway_time,cut_before_refinement,cut_after_refinement,cut_delta\n";
+
+        for( size_t i = 0; i < m_levels.size(); i++) {
+                const level_statistics & r = m_levels[i];
+                out << r.run << "," << r.cycle << "," << r.level << "," << r.nodes << "," << r.edges << ","
+                    << r.lp_iterations << "," << r.labels_changed << "," << r.coarse_nodes << ","
+                    << r.lp_time << "," << r.contraction_time << ","
+                    << r.lp_refinement_iterations << "," << r.lp_refinement_moves << "," << r.lp_refinement_time << ","
+                    << r.cluster_merges << "," << r.cluster_merge_time << ","
+                    << r.kway_moves << "," << r.kway_rollbacks << "," << r.kway_time << ","
+                    << r.cut_before_refinement << "," << r.cut_after_refinement << ","
+                    << r.cut_after_refinement - r.cut_before_refinement << "\n";
+        }
+}
+
+void clustering_statistics::write_json(std::ostream & out) const {
+        out << "[\n";
+        for( size_t i = 0; i < m_levels.size(); i++) {
+                const level_statistics & r = m_levels[i];
+                out << "  {\"run\": " << r.run
+                    << ", \"cycle\": " << r.cycle
+                    << ", \"level\": " << r.level
+                    << ", \"nodes\": " << r.nodes
+                    << ", \"edges\": " << r.edges
+                    << ", \"lp_iterations\": " << r.lp_iterations
+                    << ", \"labels_changed\": " << r.labels_changed
+                    << ", \"coarse_nodes\": " << r.coarse_nodes
+                    << ", \"lp_time\": " << r.lp_time
+                    << ", \"contraction_time\": " << r.contraction_time
+                    << ", \"lp_refinement_iterations\": " << r.lp_refinement_iterations
+                    << ", \"lp_refinement_moves\": " << r.lp_refinement_moves
+                    << ", \"lp_refinement_time\": " << r.lp_refinement_time
+                    << ", \"cluster_merges\": " << r.cluster_merges
+                    << ", \"cluster_merge_time\": " << r.cluster_merge_time
+                    << ", \"kway_moves\": " << r.kway_moves
+                    << ", \"kway_rollbacks\": " << r.kway_rollbacks
+                    << ", \"kway_time\": " << r.kway_time
+                    << ", \"cut_before_refinement\": " << r.cut_before_refinement
+                    << ", \"cut_after_refinement\": " << r.cut_after_refinement
+                    << ", \"cut_delta\": " << r.cut_after_refinement - r.cut_before_refinement
+                    << "}" << (i + 1 < m_levels.size() ? "," : "") << "\n";
+        }
+        out << "]\n";
+}
@@ -0,0 +1,76 @@
+/******************************************************************************
+ * clustering_statistics.h
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#ifndef CLUSTERING_STATISTICS_R7HXT2MV
+#define CLUSTERING_STATISTICS_R7HXT2MV
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "definitions.h"
+
+// counters and timings of one level of the hierarchy in one global cycle of one clustering run.
+// level 0 is the input graph, the coarsening fields describe the clustering/contraction of this
+// level, the refinement fields the local search on this level during uncoarsening.
+struct level_statistics {
+        unsigned    run;
+        unsigned    cycle;
+        unsigned    level;
+        NodeID      nodes;
+        EdgeID      edges;
+
+        // coarsening
+        unsigned    lp_iterations;
+        NodeID      labels_changed;
+        NodeID      coarse_nodes;
+        double      lp_time;
+        double      contraction_time;
+
+        // uncoarsening
+        unsigned    lp_refinement_iterations;
+        NodeID      lp_refinement_moves;
+        double      lp_refinement_time;
+        NodeID      cluster_merges;
+        double      cluster_merge_time;
+        EdgeID      kway_moves;
+        EdgeID      kway_rollbacks;
+        double      kway_time;
+        EdgeWeight  cut_before_refinement;
+        EdgeWeight  cut_after_refinement;
+};
+
+// Collects level_statistics if PartitionConfig::statistics points to an instance, i.e. if
+// --statistics_output is given. The algorithms only touch it behind a NULL check.
+class clustering_statistics {
+        public:
+                clustering_statistics() : m_run(0), m_cycle(0), m_current(NULL) {};
+                virtual ~clustering_statistics() {};
+
+                void start_run()   { m_run++; m_cycle = 0; };
+                void start_cycle() { m_cycle++; };
+
+                // selects the record of a level in the current cycle (and creates it if necessary),
+                // counters of the algorithms are added to the selected record
+                level_statistics & select_level(unsigned level, NodeID nodes, EdgeID edges);
+                level_statistics & current() { return *m_current; };
+
+                // csv if the filename ends with .csv, json otherwise
+                void write(const std::string & filename) const;
+                // file of one MPI process, out.csv becomes out_<rank>.csv
+                static std::string filename_of_rank(const std::string & filename, int rank);
+                void write_json(std::ostream & out) const;
+                void write_csv(std::ostream & out) const;
+
+        private:
+                unsigned                      m_run;
+                unsigned                      m_cycle;
+                std::vector<level_statistics> m_levels;
+                level_statistics *            m_current;
+};
+
+#endif /* end of include guard: CLUSTERING_STATISTICS_R7HXT2MV */
@@ -8,6 +8,21 @@
 #ifndef MPI_TOOLS_HMESDXF2
 #define MPI_TOOLS_HMESDXF2
 
+#include <mpi.h>
+
+#include "definitions.h"
+
+// MPI data types that match the types of definitions.h (see the 64BITMODE cmake option)
+#ifdef MODE64BITEDGES
+#define MPI_EDGEWEIGHT MPI_LONG_LONG
+#define MPI_NODEWEIGHT MPI_UNSIGNED_LONG_LONG
+#define MPI_NODEID     MPI_UNSIGNED_LONG_LONG
+#else
+#define MPI_EDGEWEIGHT MPI_INT
+#define MPI_NODEWEIGHT MPI_UNSIGNED
+#define MPI_NODEID     MPI_UNSIGNED
+#endif
+#define MPI_PARTITIONID MPI_UNSIGNED
 
 class mpi_tools {
 public:
@@ -5,13 +5,32 @@
  * Christian Schulz <christian.schulz.phone@gmail.com>
  *****************************************************************************/
 
+#include <omp.h>
+
 #include "random_functions.h"
 
-MersenneTwister random_functions::m_mt;
-int random_functions::m_seed = 0;
+int random_functions::s_seed                           = 0;
+unsigned random_functions::s_generation                = 1;
+thread_local unsigned random_functions::m_generation   = 0;
+thread_local MersenneTwister random_functions::m_mt;
 
 random_functions::random_functions()  {
 }
 
 random_functions::~random_functions() {
 }
+
+void random_functions::setSeed(int seed) {
+        srand(seed);
+        m_mt.seed(seed);
+        if( !omp_in_parallel() ) {
+                s_seed = seed;
+                __atomic_add_fetch(&s_generation, 1, __ATOMIC_RELAXED);
+        }
+        m_generation = __atomic_load_n(&s_generation, __ATOMIC_RELAXED);
+}
+
+void random_functions::seed_thread() {
+        m_generation = __atomic_load_n(&s_generation, __ATOMIC_RELAXED);
+        m_mt.seed((MersenneTwister::result_type) counter_based(s_seed, omp_get_thread_num(), 0));
+}
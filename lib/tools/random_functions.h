@@ -34,13 +34,14 @@ class random_functions {
                                 unsigned int size = vec.size();
                                 std::uniform_int_distribution<unsigned int> A(0,size-1);
                                 std::uniform_int_distribution<unsigned int> B(0,size-1);
+                                MersenneTwister & mt = generator();
 
                                 for( unsigned int i = 0; i < size; i++) {
-                                        unsigned int posA = A(m_mt);
-                                        unsigned int posB = B(m_mt);
+                                        unsigned int posA = A(mt);
+                                        unsigned int posB = B(mt);
 
                                         while(posB == posA) {
-                                                posB = B(m_mt);
+                                                posB = B(mt);
                                         }
 
                                         if( posA != vec[posB] && posB != vec[posA]) {
@@ -63,9 +64,10 @@ class random_functions {
                                 int distance = 20; 
                                 std::uniform_int_distribution<unsigned int> A(0, distance);
                                 unsigned int size = vec.size()-4;
+                                MersenneTwister & mt = generator();
                                 for( unsigned int i = 0; i < size; i++) {
                                         unsigned int posA = i;
-                                        unsigned int posB = (posA + A(m_mt))%size;
+                                        unsigned int posB = (posA + A(mt))%size;
                                         std::swap(vec[posA], vec[posB]);
                                         std::swap(vec[posA+1], vec[posB+1]); 
                                         std::swap(vec[posA+2], vec[posB+2]); 
@@ -81,9 +83,10 @@ class random_functions {
                         std::uniform_int_distribution<unsigned int> A(0,size - 4);
                         std::uniform_int_distribution<unsigned int> B(0,size - 4);
 
+                        MersenneTwister & mt = generator();
                         for( unsigned int i = 0; i < size; i++) {
-                                unsigned int posA = A(m_mt);
-                                unsigned int posB = B(m_mt);
+                                unsigned int posA = A(mt);
+                                unsigned int posB = B(mt);
                                 std::swap(vec[posA], vec[posB]); 
                                 std::swap(vec[posA+1], vec[posB+1]); 
                                 std::swap(vec[posA+2], vec[posB+2]); 
@@ -108,9 +111,10 @@ class random_functions {
                                 std::uniform_int_distribution<unsigned int> A(0,size - 4);
                                 std::uniform_int_distribution<unsigned int> B(0,size - 4);
 
+                                MersenneTwister & mt = generator();
                                 for( unsigned int i = 0; i < size; i++) {
-                                        unsigned int posA = A(m_mt);
-                                        unsigned int posB = B(m_mt);
+                                        unsigned int posA = A(mt);
+                                        unsigned int posB = B(mt);
                                         std::swap(vec[posA], vec[posB]); 
                                         std::swap(vec[posA+1], vec[posB+1]); 
                                         std::swap(vec[posA+2], vec[posB+2]); 
@@ -126,9 +130,10 @@ class random_functions {
                                 std::uniform_int_distribution<unsigned int> A(0,size-1);
                                 std::uniform_int_distribution<unsigned int> B(0,size-1);
 
+                                MersenneTwister & mt = generator();
                                 for( unsigned int i = 0; i < size; i++) {
-                                        unsigned int posA = A(m_mt);
-                                        unsigned int posB = B(m_mt);
+                                        unsigned int posA = A(mt);
+                                        unsigned int posB = B(mt);
                                         std::swap(vec[posA], vec[posB]); 
                                 } 
                         }
@@ -153,14 +158,14 @@ class random_functions {
 
                 static bool nextBool() {
                         std::uniform_int_distribution<unsigned int> A(0,1);
-                        return (bool) A(m_mt); 
+                        return (bool) A(generator()); 
                 }
 
 		template <typename U = uint64_t> class fastRandBool {
 			public:
 				bool nextBool() {
 					if (UNLIKELY(1 == m_rand)) {
-						m_rand = std::uniform_int_distribution<U>{}(m_mt) | s_mask_left1;
+						m_rand = std::uniform_int_distribution<U>{}(generator()) | s_mask_left1;
 					}
 					bool const ret = m_rand & 1;
 					m_rand >>= 1;
@@ -192,7 +197,7 @@ class random_functions {
                 //including lb and rb
                 static unsigned nextInt(unsigned int lb, unsigned int rb) {
                         std::uniform_int_distribution<unsigned int> A(lb,rb);
-                        return A(m_mt); 
+                        return A(generator()); 
                 }
 
                 static double nextDouble(double lb, double rb) {
@@ -204,15 +209,36 @@ class random_functions {
                         return rnbr; 
                 }
 
-                static void setSeed(int seed) {
-                        m_seed = seed;
-                        srand(seed);
-                        m_mt.seed(m_seed);
+                // counter based random number (splitmix64 finalizer) of the key (seed, a, b). it only depends
+                // on the key, not on the thread or on the order of the calls
+                static inline uint64_t counter_based(uint64_t seed, uint64_t a, uint64_t b) {
+                        uint64_t x = seed + 0x9E3779B97F4A7C15ull * (a + 1) + 0xBF58476D1CE4E5B9ull * (b + 1);
+                        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+                        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+                        return x ^ (x >> 31);
                 }
 
+                // seeds the generator of the calling thread. outside of a parallel region the seed is also
+                // the base seed of all other threads
+                static void setSeed(int seed);
+
         private:
-                static int m_seed;
-                static MersenneTwister m_mt;
+                // every thread has its own generator. a thread that was not seeded by setSeed since the last
+                // base seed derives its seed from the base seed and its thread id on first use. functions
+                // that draw many numbers look the generator up once
+                static inline MersenneTwister & generator() {
+                        if( UNLIKELY(m_generation != __atomic_load_n(&s_generation, __ATOMIC_RELAXED)) ) {
+                                seed_thread();
+                        }
+                        return m_mt;
+                }
+
+                static void seed_thread();
+
+                static int s_seed;
+                static unsigned s_generation; // incremented by every base seed
+                static thread_local unsigned m_generation;
+                static thread_local MersenneTwister m_mt;
 };
 
 #endif /* end of include guard: RANDOM_FUNCTIONS_RMEPKWYT */
@@ -0,0 +1,56 @@
+/******************************************************************************
+ * clustering_workspace_test.cpp
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#include <iostream>
+#include <vector>
+
+#include "data_structure/clustering_workspace.h"
+
+// Edges of the coarse levels of one global cycle, finest first.
+static const EdgeID LEVEL_EDGES[] = {100000, 30000, 9000, 2700, 800};
+static const unsigned NO_OF_LEVELS = sizeof(LEVEL_EDGES) / sizeof(LEVEL_EDGES[0]);
+
+// Acquires and builds the levels like coarsening does, then releases them in the order of
+// uncoarsening and signed_graph_clusterer: the finer levels from the second coarsest one upwards,
+// the coarsest one and the first level last. Returns the edge capacity of all graphs.
+static size_t perform_cycle(clustering_workspace & workspace) {
+        std::vector<graph_access*> levels(NO_OF_LEVELS);
+        for( unsigned level = 0; level < NO_OF_LEVELS; level++) {
+                levels[level] = workspace.acquire_graph();
+                levels[level]->start_bulk_construction(LEVEL_EDGES[level] / 4, LEVEL_EDGES[level]);
+                levels[level]->finish_bulk_construction();
+        }
+
+        size_t capacity = 0;
+        for( unsigned level = 0; level < NO_OF_LEVELS; level++) {
+                capacity += levels[level]->edge_capacity();
+        }
+
+        for( unsigned level = NO_OF_LEVELS - 2; level > 0; level--) {
+                workspace.release_graph(levels[level]);
+        }
+        workspace.release_graph(levels[NO_OF_LEVELS - 1]);
+        workspace.release_graph(levels[0]);
+        return capacity;
+}
+
+int main() {
+        clustering_workspace workspace;
+
+        // every level gets back the graph of its size, the capacities (and the peak memory) stay flat
+        size_t first_cycle = perform_cycle(workspace);
+        for( unsigned cycle = 1; cycle < 5; cycle++) {
+                size_t capacity = perform_cycle(workspace);
+                if( capacity != first_cycle ) {
+                        std::cout << "cycle " << cycle << ": edge capacity " << capacity
+                                  << ", first cycle " << first_cycle << std::endl;
+                        return 1;
+                }
+        }
+
+        return 0;
+}
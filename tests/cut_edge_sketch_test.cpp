@@ -0,0 +1,136 @@
+/******************************************************************************
+ * cut_edge_sketch_test.cpp
+ * *
+ * Source of KaHIP -- Karlsruhe High Quality Partitioning.
+ * Christian Schulz <christian.schulz.phone@gmail.com>
+ *****************************************************************************/
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "data_structure/cut_edge_sketch.h"
+
+class edge_iterator {
+        public:
+                edge_iterator(const std::vector<EdgeID> & edges) : m_edges(edges), m_position(0) {};
+
+                bool done() const { return m_position == m_edges.size(); };
+                EdgeID next() { return m_edges[m_position++]; };
+
+        private:
+                const std::vector<EdgeID> & m_edges;
+                size_t                      m_position;
+};
+
+static bool check_difference(const std::vector<EdgeID> & lhs, const std::vector<EdgeID> & rhs,
+                             unsigned sketch_size, double expected) {
+        cut_edge_sketch lhs_sketch, rhs_sketch;
+        lhs_sketch.build(edge_iterator(lhs), sketch_size);
+        rhs_sketch.build(edge_iterator(rhs), sketch_size);
+
+        double standard_error;
+        double difference = cut_edge_sketch::estimate_symmetric_difference(lhs_sketch, rhs_sketch, standard_error);
+        if( difference != expected || standard_error != 0 ) {
+                std::cout << "expected " << expected << ", got " << difference
+                          << " (standard error " << standard_error << ")" << std::endl;
+                return false;
+        }
+        return true;
+}
+
+// the consecutive edge ids [begin, end)
+class range_iterator {
+        public:
+                range_iterator(EdgeID begin, EdgeID end) : m_position(begin), m_end(end) {};
+
+                bool done() const { return m_position == m_end; };
+                EdgeID next() { return m_position++; };
+
+        private:
+                EdgeID m_position;
+                EdgeID m_end;
+};
+
+// [0, size) and [offset, size + offset) have the Jaccard similarity (size - offset) / (size + offset)
+// and the symmetric difference 2 * offset. The hash is fixed, so the estimate is deterministic.
+static bool check_estimate(EdgeID size, EdgeID offset, unsigned sketch_size) {
+        cut_edge_sketch lhs_sketch, rhs_sketch;
+        lhs_sketch.build(range_iterator(0, size), sketch_size);
+        rhs_sketch.build(range_iterator(offset, size + offset), sketch_size);
+
+        double standard_error;
+        double difference = cut_edge_sketch::estimate_symmetric_difference(lhs_sketch, rhs_sketch, standard_error);
+        double expected   = 2.0 * offset;
+        if( lhs_sketch.is_exact() || standard_error <= 0 || std::fabs(difference - expected) > 3 * standard_error ) {
+                std::cout << "size " << size << ", offset " << offset << ": expected " << expected << ", got " << difference
+                          << " (standard error " << standard_error << ")" << std::endl;
+                return false;
+        }
+        return true;
+}
+
+static bool check_selection(const std::vector<unsigned> & selected, const std::vector<unsigned> & expected) {
+        if( selected != expected ) {
+                std::cout << "selected";
+                for( unsigned s : selected ) std::cout << " " << s;
+                std::cout << ", expected";
+                for( unsigned e : expected ) std::cout << " " << e;
+                std::cout << std::endl;
+                return false;
+        }
+        return true;
+}
+
+// the candidates for the replacement in population::insert
+static bool check_most_similar() {
+        const unsigned sketch_size = 256;
+        cut_edge_sketch query;
+        query.build(range_iterator(0, 100000), sketch_size);
+
+        // symmetric differences to the query 28000, 20000, 24000 and 100000, estimated as
+        // 28571 +- 3535, 17872 +- 2747, 22126 +- 3079 and 99415 +- 6616
+        const EdgeID offsets[] = {14000, 10000, 12000, 50000};
+        std::vector<cut_edge_sketch> candidates(4);
+        std::vector<const cut_edge_sketch*> sketches;
+        for( unsigned c = 0; c < candidates.size(); c++) {
+                candidates[c].build(range_iterator(offsets[c], 100000 + offsets[c]), sketch_size);
+                sketches.push_back(&candidates[c]);
+        }
+
+        bool ok = true;
+        std::vector<unsigned> selected;
+
+        // without verification only the smallest estimate is kept
+        cut_edge_sketch::select_most_similar(sketches, query, false, selected);
+        ok &= check_selection(selected, {1});
+
+        // with verification every candidate within two standard errors of the smallest estimate is
+        // measured exactly: 22126 - 2 * 3079 <= 17872 < 28571 - 2 * 3535
+        cut_edge_sketch::select_most_similar(sketches, query, true, selected);
+        ok &= check_selection(selected, {1, 2});
+        return ok;
+}
+
+int main() {
+        bool ok = true;
+
+        // complete sets whose union is larger than the sketch size
+        ok &= check_difference({1, 2, 3, 100}, {4, 5, 6, 100}, 4, 6);
+        ok &= check_difference({1, 2, 3, 4}, {5, 6, 7, 8}, 4, 8);
+        ok &= check_difference({1, 2, 3, 4}, {1, 2, 3, 4}, 4, 0);
+
+        // complete sets smaller than the sketch size
+        ok &= check_difference({1, 5, 9}, {5, 9, 11, 12}, 64, 3);
+        ok &= check_difference({}, {7}, 8, 1);
+
+        // large sets, the estimate is within three standard errors of the exact size
+        ok &= check_estimate(100000, 50000, 256);
+        ok &= check_estimate(100000, 10000, 256);
+        ok &= check_estimate(100000, 80000, 64);
+        ok &= check_estimate(1000000, 1000, 1024);
+
+        ok &= check_most_similar();
+
+        return ok ? 0 : 1;
+}